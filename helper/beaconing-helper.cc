@@ -35,6 +35,7 @@ NS_LOG_COMPONENT_DEFINE ("BeaconingHelper");
 BeaconingHelper::BeaconingHelper ()
 {
   m_factory.SetTypeId ("ns3::Beaconing");
+  m_beaconTimer = CreateObject<BeaconTimer> ();
 }
 
 BeaconingHelper::~BeaconingHelper ()
@@ -53,6 +54,18 @@ BeaconingHelper::SetDeviceType(Beaconing::DeviceType deviceType)
   m_deviceType = deviceType;
 }
 
+void
+BeaconingHelper::SetBeaconTimer (Ptr<BeaconTimer> beaconTimer)
+{
+  m_beaconTimer = beaconTimer;
+}
+
+Ptr<BeaconTimer>
+BeaconingHelper::GetBeaconTimer (void) const
+{
+  return m_beaconTimer;
+}
+
 ApplicationContainer
 BeaconingHelper::Install (Ptr<Node> node) const
 {
@@ -79,6 +92,7 @@ BeaconingHelper::InstallPriv (Ptr<Node> node) const
   Ptr<Beaconing> app = m_factory.Create<Beaconing> ();
 
   app->SetDeviceType (m_deviceType);
+  app->SetBeaconTimer (m_beaconTimer);
   app->SetNode (node);
   node->AddApplication (app);
 
@@ -37,6 +37,9 @@ namespace lorawan {
 /**
  * This class can be used to install Beaconing applications on a set of
  * gateways.
+ *
+ * All the applications installed by the same helper share a single
+ * BeaconTimer, so that beacons are driven by one event per beacon period.
  */
 class BeaconingHelper
 {
@@ -49,6 +52,16 @@ public:
 
   void SetDeviceType (Beaconing::DeviceType deviceType);
 
+  /**
+   * Set the timer to share between the installed applications.
+   */
+  void SetBeaconTimer (Ptr<BeaconTimer> beaconTimer);
+
+  /**
+   * Get the timer shared between the installed applications.
+   */
+  Ptr<BeaconTimer> GetBeaconTimer (void) const;
+
   ApplicationContainer Install (NodeContainer c) const;
 
   ApplicationContainer Install (Ptr<Node> node) const;
@@ -59,6 +72,8 @@ private:
   ObjectFactory m_factory;
 
   Beaconing::DeviceType m_deviceType;
+
+  Ptr<BeaconTimer> m_beaconTimer;
 };
 
 } // namespace ns3
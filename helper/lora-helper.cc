@@ -108,6 +108,14 @@ NS_LOG_COMPONENT_DEFINE ("LoraHelper");
       NS_ASSERT (mac != 0);
       mac->SetPhy (phy);
       NS_LOG_DEBUG ("Done creating the MAC");
+
+      // Class C devices listen continuously, and downlinks addressed to
+      // other devices are only interference to them
+      Ptr<ClassCEndDeviceLorawanMac> classCMac = mac->GetObject<ClassCEndDeviceLorawanMac> ();
+      if (classCMac)
+        {
+          phy->SetAddressFilter (classCMac->GetDeviceAddress ());
+        }
       device->SetMac (mac);
 
       if (m_packetTracker)
@@ -83,6 +83,23 @@ LorawanMacHelper::SetRegion (enum LorawanMacHelper::Regions region)
   m_region = region;
 }
 
+Ptr<const RegionProfile>
+LorawanMacHelper::GetRegionProfile (void) const
+{
+  switch (m_region)
+    {
+    case LorawanMacHelper::EU:
+      return GetEuProfile ();
+    case LorawanMacHelper::SingleChannel:
+      return GetSingleChannelProfile ();
+    case LorawanMacHelper::ALOHA:
+      return GetAlohaProfile ();
+    default:
+      NS_LOG_ERROR ("This region isn't supported yet!");
+      return 0;
+    }
+}
+
 Ptr<LorawanMac>
 LorawanMacHelper::Create (Ptr<Node> node, Ptr<NetDevice> device) const
 {
@@ -200,24 +217,6 @@ LorawanMacHelper::ConfigureForAlohaRegion (Ptr<ClassAEndDeviceLorawanMac> edMac)
 
   ApplyCommonAlohaConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -237,24 +236,6 @@ LorawanMacHelper::ConfigureForAlohaRegion (Ptr<ClassBEndDeviceLorawanMac> edMac)
 
   ApplyCommonAlohaConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -286,24 +267,6 @@ LorawanMacHelper::ConfigureForAlohaRegion (Ptr<ClassCEndDeviceLorawanMac> edMac)
 
   ApplyCommonAlohaConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -349,56 +312,78 @@ LorawanMacHelper::ApplyCommonAlohaConfigurations (Ptr<LorawanMac> lorawanMac) co
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  //////////////
-  // SubBands //
-  //////////////
+  Ptr<const RegionProfile> regionProfile = GetAlohaProfile ();
 
   LogicalLoraChannelHelper channelHelper;
-  channelHelper.AddSubBand (868, 868.6, 1, 14);
+  regionProfile->ConfigureChannelHelper (channelHelper);
+  lorawanMac->SetLogicalLoraChannelHelper (channelHelper);
 
-  //////////////////////
-  // Default channels //
-  //////////////////////
-  Ptr<LogicalLoraChannel> lc1 = CreateObject<LogicalLoraChannel> (868.1, 0, 5);
-  channelHelper.AddChannel (lc1);
+  lorawanMac->SetRegionProfile (regionProfile);
+}
 
-  lorawanMac->SetLogicalLoraChannelHelper (channelHelper);
+Ptr<const RegionProfile>
+LorawanMacHelper::GetAlohaProfile (void) const
+{
+  // Built once, then shared by all the MACs this helper configures
+  if (!m_alohaProfile)
+    {
+      Ptr<RegionProfile> regionProfile = ns3::Create<RegionProfile> ();
+
+      //////////////
+      // SubBands //
+      //////////////
+      regionProfile->AddSubBand (868, 868.6, 1, 14);
+
+      //////////////////////
+      // Default channels //
+      //////////////////////
+      regionProfile->AddChannel (CreateObject<LogicalLoraChannel> (868.1, 0, 5));
 
+      AddCommonDataRateTables (regionProfile);
+
+      m_alohaProfile = regionProfile;
+    }
+  return m_alohaProfile;
+}
+
+void
+LorawanMacHelper::AddCommonDataRateTables (Ptr<RegionProfile> regionProfile) const
+{
   ///////////////////////////////////////////////
   // DataRate -> SF, DataRate -> Bandwidth     //
   // and DataRate -> MaxAppPayload conversions //
   ///////////////////////////////////////////////
-  lorawanMac->SetSfForDataRate (std::vector<uint8_t>{12, 11, 10, 9, 8, 7, 7});
-  lorawanMac->SetBandwidthForDataRate (
+  regionProfile->SetSfForDataRate (std::vector<uint8_t>{12, 11, 10, 9, 8, 7, 7});
+  regionProfile->SetBandwidthForDataRate (
       std::vector<double>{125000, 125000, 125000, 125000, 125000, 125000, 250000});
-  lorawanMac->SetMaxAppPayloadForDataRate (
+  regionProfile->SetMaxAppPayloadForDataRate (
       std::vector<uint32_t>{59, 59, 59, 123, 230, 230, 230, 230});
-}
-
-void
-LorawanMacHelper::ConfigureForEuRegion (Ptr<ClassAEndDeviceLorawanMac> edMac) const
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  ApplyCommonEuConfigurations (edMac);
 
   /////////////////////////////////////////////////////
   // TxPower -> Transmission power in dBm conversion //
   /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
+  regionProfile->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
 
   ////////////////////////////////////////////////////////////
   // Matrix to know which DataRate the GW will respond with //
   ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
+  RegionProfile::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
+                                                {{1, 0, 0, 0, 0, 0}},
+                                                {{2, 1, 0, 0, 0, 0}},
+                                                {{3, 2, 1, 0, 0, 0}},
+                                                {{4, 3, 2, 1, 0, 0}},
+                                                {{5, 4, 3, 2, 1, 0}},
+                                                {{6, 5, 4, 3, 2, 1}},
+                                                {{7, 6, 5, 4, 3, 2}}}};
+  regionProfile->SetReplyDataRateMatrix (matrix);
+}
+
+void
+LorawanMacHelper::ConfigureForEuRegion (Ptr<ClassAEndDeviceLorawanMac> edMac) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  ApplyCommonEuConfigurations (edMac);
 
   /////////////////////
   // Preamble length //
@@ -419,24 +404,6 @@ LorawanMacHelper::ConfigureForEuRegion (Ptr<ClassBEndDeviceLorawanMac> edMac) co
 
   ApplyCommonEuConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -468,24 +435,6 @@ LorawanMacHelper::ConfigureForEuRegion (Ptr<ClassCEndDeviceLorawanMac> edMac) co
 
   ApplyCommonEuConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -540,36 +489,42 @@ LorawanMacHelper::ApplyCommonEuConfigurations (Ptr<LorawanMac> lorawanMac) const
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  //////////////
-  // SubBands //
-  //////////////
+  Ptr<const RegionProfile> regionProfile = GetEuProfile ();
 
   LogicalLoraChannelHelper channelHelper;
-  channelHelper.AddSubBand (868, 868.6, 0.01, 14);
-  channelHelper.AddSubBand (868.7, 869.2, 0.001, 14);
-  channelHelper.AddSubBand (869.4, 869.65, 0.1, 27);
-
-  //////////////////////
-  // Default channels //
-  //////////////////////
-  Ptr<LogicalLoraChannel> lc1 = CreateObject<LogicalLoraChannel> (868.1, 0, 5);
-  Ptr<LogicalLoraChannel> lc2 = CreateObject<LogicalLoraChannel> (868.3, 0, 5);
-  Ptr<LogicalLoraChannel> lc3 = CreateObject<LogicalLoraChannel> (868.5, 0, 5);
-  channelHelper.AddChannel (lc1);
-  channelHelper.AddChannel (lc2);
-  channelHelper.AddChannel (lc3);
-
+  regionProfile->ConfigureChannelHelper (channelHelper);
   lorawanMac->SetLogicalLoraChannelHelper (channelHelper);
 
-  ///////////////////////////////////////////////
-  // DataRate -> SF, DataRate -> Bandwidth     //
-  // and DataRate -> MaxAppPayload conversions //
-  ///////////////////////////////////////////////
-  lorawanMac->SetSfForDataRate (std::vector<uint8_t>{12, 11, 10, 9, 8, 7, 7});
-  lorawanMac->SetBandwidthForDataRate (
-      std::vector<double>{125000, 125000, 125000, 125000, 125000, 125000, 250000});
-  lorawanMac->SetMaxAppPayloadForDataRate (
-      std::vector<uint32_t>{59, 59, 59, 123, 230, 230, 230, 230});
+  lorawanMac->SetRegionProfile (regionProfile);
+}
+
+Ptr<const RegionProfile>
+LorawanMacHelper::GetEuProfile (void) const
+{
+  // Built once, then shared by all the MACs this helper configures
+  if (!m_euProfile)
+    {
+      Ptr<RegionProfile> regionProfile = ns3::Create<RegionProfile> ();
+
+      //////////////
+      // SubBands //
+      //////////////
+      regionProfile->AddSubBand (868, 868.6, 0.01, 14);
+      regionProfile->AddSubBand (868.7, 869.2, 0.001, 14);
+      regionProfile->AddSubBand (869.4, 869.65, 0.1, 27);
+
+      //////////////////////
+      // Default channels //
+      //////////////////////
+      regionProfile->AddChannel (CreateObject<LogicalLoraChannel> (868.1, 0, 5));
+      regionProfile->AddChannel (CreateObject<LogicalLoraChannel> (868.3, 0, 5));
+      regionProfile->AddChannel (CreateObject<LogicalLoraChannel> (868.5, 0, 5));
+
+      AddCommonDataRateTables (regionProfile);
+
+      m_euProfile = regionProfile;
+    }
+  return m_euProfile;
 }
 
 ///////////////////////////////
@@ -581,24 +536,6 @@ LorawanMacHelper::ConfigureForSingleChannelRegion (Ptr<ClassAEndDeviceLorawanMac
 
   ApplyCommonSingleChannelConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -618,24 +555,6 @@ LorawanMacHelper::ConfigureForSingleChannelRegion (Ptr<ClassBEndDeviceLorawanMac
 
   ApplyCommonSingleChannelConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -667,24 +586,6 @@ LorawanMacHelper::ConfigureForSingleChannelRegion (Ptr<ClassCEndDeviceLorawanMac
 
   ApplyCommonSingleChannelConfigurations (edMac);
 
-  /////////////////////////////////////////////////////
-  // TxPower -> Transmission power in dBm conversion //
-  /////////////////////////////////////////////////////
-  edMac->SetTxDbmForTxPower (std::vector<double>{16, 14, 12, 10, 8, 6, 4, 2});
-
-  ////////////////////////////////////////////////////////////
-  // Matrix to know which DataRate the GW will respond with //
-  ////////////////////////////////////////////////////////////
-  LorawanMac::ReplyDataRateMatrix matrix = {{{{0, 0, 0, 0, 0, 0}},
-                                             {{1, 0, 0, 0, 0, 0}},
-                                             {{2, 1, 0, 0, 0, 0}},
-                                             {{3, 2, 1, 0, 0, 0}},
-                                             {{4, 3, 2, 1, 0, 0}},
-                                             {{5, 4, 3, 2, 1, 0}},
-                                             {{6, 5, 4, 3, 2, 1}},
-                                             {{7, 6, 5, 4, 3, 2}}}};
-  edMac->SetReplyDataRateMatrix (matrix);
-
   /////////////////////
   // Preamble length //
   /////////////////////
@@ -738,32 +639,40 @@ LorawanMacHelper::ApplyCommonSingleChannelConfigurations (Ptr<LorawanMac> lorawa
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  //////////////
-  // SubBands //
-  //////////////
+  Ptr<const RegionProfile> regionProfile = GetSingleChannelProfile ();
 
   LogicalLoraChannelHelper channelHelper;
-  channelHelper.AddSubBand (868, 868.6, 0.01, 14);
-  channelHelper.AddSubBand (868.7, 869.2, 0.001, 14);
-  channelHelper.AddSubBand (869.4, 869.65, 0.1, 27);
+  regionProfile->ConfigureChannelHelper (channelHelper);
+  lorawanMac->SetLogicalLoraChannelHelper (channelHelper);
 
-  //////////////////////
-  // Default channels //
-  //////////////////////
-  Ptr<LogicalLoraChannel> lc1 = CreateObject<LogicalLoraChannel> (868.1, 0, 5);
-  channelHelper.AddChannel (lc1);
+  lorawanMac->SetRegionProfile (regionProfile);
+}
 
-  lorawanMac->SetLogicalLoraChannelHelper (channelHelper);
+Ptr<const RegionProfile>
+LorawanMacHelper::GetSingleChannelProfile (void) const
+{
+  // Built once, then shared by all the MACs this helper configures
+  if (!m_singleChannelProfile)
+    {
+      Ptr<RegionProfile> regionProfile = ns3::Create<RegionProfile> ();
 
-  ///////////////////////////////////////////////
-  // DataRate -> SF, DataRate -> Bandwidth     //
-  // and DataRate -> MaxAppPayload conversions //
-  ///////////////////////////////////////////////
-  lorawanMac->SetSfForDataRate (std::vector<uint8_t>{12, 11, 10, 9, 8, 7, 7});
-  lorawanMac->SetBandwidthForDataRate (
-      std::vector<double>{125000, 125000, 125000, 125000, 125000, 125000, 250000});
-  lorawanMac->SetMaxAppPayloadForDataRate (
-      std::vector<uint32_t>{59, 59, 59, 123, 230, 230, 230, 230});
+      //////////////
+      // SubBands //
+      //////////////
+      regionProfile->AddSubBand (868, 868.6, 0.01, 14);
+      regionProfile->AddSubBand (868.7, 869.2, 0.001, 14);
+      regionProfile->AddSubBand (869.4, 869.65, 0.1, 27);
+
+      //////////////////////
+      // Default channels //
+      //////////////////////
+      regionProfile->AddChannel (CreateObject<LogicalLoraChannel> (868.1, 0, 5));
+
+      AddCommonDataRateTables (regionProfile);
+
+      m_singleChannelProfile = regionProfile;
+    }
+  return m_singleChannelProfile;
 }
 
 std::vector<int>
@@ -776,8 +685,7 @@ LorawanMacHelper::SetSpreadingFactorsUp (NodeContainer endDevices, NodeContainer
   for (NodeContainer::Iterator j = endDevices.Begin (); j != endDevices.End (); ++j)
     {
       Ptr<Node> object = *j;
-      Ptr<MobilityModel> position = object->GetObject<MobilityModel> ();
-      NS_ASSERT (position != 0);
+      NS_ASSERT (object->GetObject<MobilityModel> () != 0);
       Ptr<NetDevice> netDevice = object->GetDevice (0);
       Ptr<LoraNetDevice> loraNetDevice = netDevice->GetObject<LoraNetDevice> ();
       NS_ASSERT (loraNetDevice != 0);
@@ -785,25 +693,29 @@ LorawanMacHelper::SetSpreadingFactorsUp (NodeContainer endDevices, NodeContainer
           loraNetDevice->GetMac ()->GetObject<EndDeviceLorawanMac> ();
       NS_ASSERT (mac != 0);
 
+      Ptr<LoraPhy> edLoraPhy = loraNetDevice->GetPhy ();
+
       // Try computing the distance from each gateway and find the best one
       Ptr<Node> bestGateway = gateways.Get (0);
-      Ptr<MobilityModel> bestGatewayPosition = bestGateway->GetObject<MobilityModel> ();
+      Ptr<LoraPhy> bestGatewayPhy =
+          bestGateway->GetDevice (0)->GetObject<LoraNetDevice> ()->GetPhy ();
 
-      // Assume devices transmit at 14 dBm
-      double highestRxPower = channel->GetRxPower (14, position, bestGatewayPosition);
+      // Assume devices transmit at 14 dBm. Going through the PHYs lets the
+      // channel reuse its stored link budgets in static topologies.
+      double highestRxPower = channel->GetRxPower (14, edLoraPhy, bestGatewayPhy);
 
       for (NodeContainer::Iterator currentGw = gateways.Begin () + 1; currentGw != gateways.End ();
            ++currentGw)
         {
           // Compute the power received from the current gateway
           Ptr<Node> curr = *currentGw;
-          Ptr<MobilityModel> currPosition = curr->GetObject<MobilityModel> ();
-          double currentRxPower = channel->GetRxPower (14, position, currPosition); // dBm
+          Ptr<LoraPhy> currPhy = curr->GetDevice (0)->GetObject<LoraNetDevice> ()->GetPhy ();
+          double currentRxPower = channel->GetRxPower (14, edLoraPhy, currPhy); // dBm
 
           if (currentRxPower > highestRxPower)
             {
               bestGateway = curr;
-              bestGatewayPosition = curr->GetObject<MobilityModel> ();
+              bestGatewayPhy = currPhy;
               highestRxPower = currentRxPower;
             }
         }
@@ -25,6 +25,7 @@
 #include "ns3/lora-channel.h"
 #include "ns3/lora-phy.h"
 #include "ns3/lorawan-mac.h"
+#include "ns3/region-profile.h"
 #include "ns3/class-a-end-device-lorawan-mac.h"
 #include "ns3/class-b-end-device-lorawan-mac.h"
 #include "ns3/class-c-end-device-lorawan-mac.h"
@@ -102,6 +103,14 @@ public:
    */
   void SetRegion (enum Regions region);
 
+  /**
+   * Get the regional parameters shared by the MACs this helper configures for
+   * the current region.
+   *
+   * \return The profile, or 0 if the region is not supported.
+   */
+  Ptr<const RegionProfile> GetRegionProfile (void) const;
+
   /**
    * Create the LorawanMac instance and connect it to a device
    *
@@ -149,6 +158,11 @@ private:
    */
   void ApplyCommonEuConfigurations (Ptr<LorawanMac> lorawanMac) const;
 
+  /**
+   * Get the regional parameters of the 868 MHz EU band, creating them the first time.
+   */
+  Ptr<const RegionProfile> GetEuProfile (void) const;
+
   /**
    * Perform region-specific configurations for the SINGLECHANNEL band.
    */
@@ -167,6 +181,11 @@ private:
    */
   void ApplyCommonSingleChannelConfigurations (Ptr<LorawanMac> lorawanMac) const;
 
+  /**
+   * Get the regional parameters of the SINGLECHANNEL band, creating them the first time.
+   */
+  Ptr<const RegionProfile> GetSingleChannelProfile (void) const;
+
   /**
    * Perform region-specific configurations for the ALOHA band.
    */
@@ -185,10 +204,24 @@ private:
    */
   void ApplyCommonAlohaConfigurations (Ptr<LorawanMac> lorawanMac) const;
 
+  /**
+   * Get the regional parameters of the ALOHA band, creating them the first time.
+   */
+  Ptr<const RegionProfile> GetAlohaProfile (void) const;
+
+  /**
+   * Add the DataRate and TxPower conversion tables, which are the same in all
+   * the supported regions, to a profile.
+   */
+  void AddCommonDataRateTables (Ptr<RegionProfile> regionProfile) const;
+
   ObjectFactory m_mac;
   Ptr<LoraDeviceAddressGenerator> m_addrGen; //!< Pointer to the address generator to use
   enum DeviceType m_deviceType; //!< The kind of device to install
   enum Regions m_region; //!< The region in which the device will operate
+  mutable Ptr<const RegionProfile> m_euProfile; //!< The shared EU parameters
+  mutable Ptr<const RegionProfile> m_singleChannelProfile; //!< The shared SingleChannel parameters
+  mutable Ptr<const RegionProfile> m_alohaProfile; //!< The shared ALOHA parameters
 };
 
 } // namespace lorawan
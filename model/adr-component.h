@@ -51,7 +51,7 @@ public:
   //Destructor
   virtual ~AdrComponent ();
 
-  void OnReceivedPacket (Ptr<const Packet> packet,
+  void OnReceivedPacket (Ptr<const UplinkContext> context,
                          Ptr<EndDeviceStatus> status,
                          Ptr<NetworkStatus> networkStatus);
 
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Dakota State University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/beacon-timer.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("BeaconTimer");
+
+NS_OBJECT_ENSURE_REGISTERED (BeaconTimer);
+
+TypeId
+BeaconTimer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BeaconTimer")
+    .SetParent<Object> ()
+    .AddConstructor<BeaconTimer> ()
+    .SetGroupName ("lorawan")
+    .AddAttribute ("BeaconPeriod",
+                   "The time between two beacons",
+                   TimeValue (Seconds (128)),
+                   MakeTimeAccessor (&BeaconTimer::m_beaconPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("BeaconOffset",
+                   "The delay of each beacon from the start of its period",
+                   TimeValue (MicroSeconds (1500)),
+                   MakeTimeAccessor (&BeaconTimer::m_beaconOffset),
+                   MakeTimeChecker ());
+  return tid;
+}
+
+BeaconTimer::BeaconTimer () :
+  m_nextBeaconIndex (0),
+  m_running (false),
+  m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BeaconTimer::~BeaconTimer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BeaconTimer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Stop ();
+  m_gateways.clear ();
+  m_endDevices.clear ();
+
+  Object::DoDispose ();
+}
+
+void
+BeaconTimer::AddGateway (Ptr<GatewayLorawanMac> gwMac)
+{
+  NS_LOG_FUNCTION (this << gwMac);
+
+  m_gateways.push_back (gwMac);
+  Start ();
+}
+
+void
+BeaconTimer::RemoveGateway (Ptr<GatewayLorawanMac> gwMac)
+{
+  NS_LOG_FUNCTION (this << gwMac);
+
+  m_gateways.erase (std::remove (m_gateways.begin (), m_gateways.end (), gwMac),
+                    m_gateways.end ());
+  StopIfIdle ();
+}
+
+void
+BeaconTimer::AddEndDevice (Ptr<ClassBEndDeviceLorawanMac> edMac)
+{
+  NS_LOG_FUNCTION (this << edMac);
+
+  m_endDevices.push_back (edMac);
+  Start ();
+}
+
+void
+BeaconTimer::RemoveEndDevice (Ptr<ClassBEndDeviceLorawanMac> edMac)
+{
+  NS_LOG_FUNCTION (this << edMac);
+
+  m_endDevices.erase (std::remove (m_endDevices.begin (), m_endDevices.end (), edMac),
+                      m_endDevices.end ());
+  StopIfIdle ();
+}
+
+Time
+BeaconTimer::GetBeaconTime (uint64_t index) const
+{
+  return m_beaconPeriod * static_cast<int64_t> (index) + m_beaconOffset;
+}
+
+Time
+BeaconTimer::GetNextBeaconTime (void) const
+{
+  if (m_running)
+    {
+      return GetBeaconTime (m_nextBeaconIndex);
+    }
+  return GetBeaconTime (GetNextBeaconIndex ());
+}
+
+uint64_t
+BeaconTimer::GetNextBeaconIndex (void) const
+{
+  // A period that starts exactly now is already over
+  return Simulator::Now ().GetTimeStep () / m_beaconPeriod.GetTimeStep () + 1;
+}
+
+void
+BeaconTimer::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_running)
+    {
+      return;
+    }
+
+  m_running = true;
+  m_nextBeaconIndex = GetNextBeaconIndex ();
+  NS_LOG_DEBUG ("First beacon at " << GetBeaconTime (m_nextBeaconIndex).GetSeconds () << " s");
+  ScheduleBeacon ();
+}
+
+void
+BeaconTimer::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Events scheduled with a context cannot be cancelled: leave the pending
+  // beacon to find out that it is stale
+  m_running = false;
+  m_generation++;
+}
+
+void
+BeaconTimer::StopIfIdle (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_gateways.empty () && m_endDevices.empty ())
+    {
+      NS_LOG_DEBUG ("No devices left, stopping the beacon timer");
+      Stop ();
+    }
+}
+
+void
+BeaconTimer::ScheduleBeacon (void)
+{
+  NS_LOG_FUNCTION (this << m_nextBeaconIndex);
+
+  // The timer belongs to no node: run it outside of any node's context,
+  // instead of inheriting the one of whoever started it
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT,
+                                  GetBeaconTime (m_nextBeaconIndex) - Simulator::Now (),
+                                  &BeaconTimer::Beacon, Ptr<BeaconTimer> (this),
+                                  m_generation);
+}
+
+void
+BeaconTimer::Beacon (uint32_t generation)
+{
+  NS_LOG_FUNCTION (this << generation << m_nextBeaconIndex);
+
+  if (generation != m_generation)
+    {
+      NS_LOG_DEBUG ("The timer was stopped, ignoring the beacon");
+      return;
+    }
+
+  // Open the receive windows first, so that end devices are already
+  // listening when the gateways start transmitting
+  for (const Ptr<ClassBEndDeviceLorawanMac> &edMac : m_endDevices)
+    {
+      edMac->OpenBeaconReceiveWindow ();
+    }
+  for (const Ptr<GatewayLorawanMac> &gwMac : m_gateways)
+    {
+      gwMac->SendBeacon ();
+    }
+
+  m_nextBeaconIndex++;
+  ScheduleBeacon ();
+}
+
+} // namespace lorawan
+} // namespace ns3
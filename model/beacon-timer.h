@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2023 Dakota State University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BEACON_TIMER_H
+#define BEACON_TIMER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/gateway-lorawan-mac.h"
+#include "ns3/class-b-end-device-lorawan-mac.h"
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * A clock that marks the beacon periods of a whole network.
+ *
+ * Gateways and class B end devices register with the timer, which uses a
+ * single event per beacon period to make all registered end devices open
+ * their beacon receive window and all registered gateways send their beacon.
+ *
+ * Beacon times are kept as integer multiples of the beacon period, so that
+ * they do not drift away from the beacon epochs over long simulations.
+ *
+ * The beacon event is scheduled with Simulator::NO_CONTEXT, since it is
+ * shared by all registered devices: the MAC methods it calls run outside of
+ * their node's context, and trace sources fired from them do not carry a
+ * node id.
+ */
+class BeaconTimer : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  BeaconTimer ();
+  virtual ~BeaconTimer ();
+
+  /**
+   * Register a gateway, that will send a beacon at each beacon time.
+   *
+   * \param gwMac The MAC layer of the gateway.
+   */
+  void AddGateway (Ptr<GatewayLorawanMac> gwMac);
+
+  /**
+   * Stop sending beacons from a gateway.
+   *
+   * \param gwMac The MAC layer of the gateway.
+   */
+  void RemoveGateway (Ptr<GatewayLorawanMac> gwMac);
+
+  /**
+   * Register a class B end device, that will open its beacon receive window
+   * at each beacon time.
+   *
+   * \param edMac The MAC layer of the end device.
+   */
+  void AddEndDevice (Ptr<ClassBEndDeviceLorawanMac> edMac);
+
+  /**
+   * Stop opening beacon receive windows on an end device.
+   *
+   * \param edMac The MAC layer of the end device.
+   */
+  void RemoveEndDevice (Ptr<ClassBEndDeviceLorawanMac> edMac);
+
+  /**
+   * Get the time of a beacon.
+   *
+   * \param index The number of beacon periods since the start of the
+   * simulation.
+   * \return The absolute time at which the beacon is sent.
+   */
+  Time GetBeaconTime (uint64_t index) const;
+
+  /**
+   * Get the time of the next beacon.
+   *
+   * \return The absolute time at which the next beacon will be sent.
+   */
+  Time GetNextBeaconTime (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Get the index of the first beacon period starting after the current
+   * time.
+   */
+  uint64_t GetNextBeaconIndex (void) const;
+
+  /**
+   * Start the timer, if there is someone to notify.
+   */
+  void Start (void);
+
+  /**
+   * Stop the timer.
+   */
+  void Stop (void);
+
+  /**
+   * Stop the timer, if there is no one left to notify.
+   */
+  void StopIfIdle (void);
+
+  /**
+   * Schedule the beacon of index m_nextBeaconIndex.
+   */
+  void ScheduleBeacon (void);
+
+  /**
+   * Notify all registered devices of the beacon, and schedule the next one.
+   *
+   * \param generation The value of m_generation when the beacon was
+   * scheduled.
+   */
+  void Beacon (uint32_t generation);
+
+  Time m_beaconPeriod; //!< The time between two beacons
+
+  Time m_beaconOffset; //!< The delay of each beacon from its period start
+
+  uint64_t m_nextBeaconIndex; //!< The index of the next scheduled beacon
+
+  bool m_running; //!< Whether the next beacon is scheduled
+
+  uint32_t m_generation; //!< Incremented each time the timer is stopped
+
+  std::vector<Ptr<GatewayLorawanMac> > m_gateways; //!< The registered gateways
+
+  std::vector<Ptr<ClassBEndDeviceLorawanMac> > m_endDevices; //!< The registered end devices
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* BEACON_TIMER_H */
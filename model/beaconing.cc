@@ -71,34 +71,55 @@ Beaconing::DeviceType Beaconing::GetDeviceType()
   return m_deviceType;
 }
 
-void Beaconing::BroadcastBeacon()
+void
+Beaconing::SetBeaconTimer (Ptr<BeaconTimer> beaconTimer)
 {
-  NS_LOG_FUNCTION(this);
+  NS_LOG_FUNCTION (this << beaconTimer);
 
-  Ptr<GatewayLorawanMac> gwMac = m_loraNetDevice->GetMac()->GetObject<GatewayLorawanMac>();
-  gwMac->SendBeacon();
-  Simulator::Schedule(Beaconing::GetNextBeaconBroadcastTime(), &Beaconing::BroadcastBeacon, this);
+  m_beaconTimer = beaconTimer;
+}
 
+Ptr<BeaconTimer>
+Beaconing::GetBeaconTimer (void)
+{
+  if (!m_beaconTimer)
+    {
+      m_beaconTimer = CreateObject<BeaconTimer> ();
+    }
+  return m_beaconTimer;
 }
 
-void Beaconing::ScheduleEndDeviceBeaconReception(){
+void
+Beaconing::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_beaconTimer = 0;
+  m_loraNetDevice = 0;
+
+  Application::DoDispose ();
+}
+
+void Beaconing::BroadcastBeacon()
+{
   NS_LOG_FUNCTION(this);
-  Ptr<ClassBEndDeviceLorawanMac> classBMac = m_loraNetDevice->
-                                             GetMac()->
-                                             GetObject<ClassBEndDeviceLorawanMac>();
-  classBMac->OpenBeaconReceiveWindow();
-  Simulator::Schedule(Beaconing::GetNextBeaconBroadcastTime(), &Beaconing::ScheduleEndDeviceBeaconReception, this);
+
+  Ptr<GatewayLorawanMac> gwMac = m_loraNetDevice->GetMac()->GetObject<GatewayLorawanMac>();
+  gwMac->SendBeacon();
 }
 
 void
 Beaconing::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
-  Time nextBroadcastTime = GetNextBeaconBroadcastTime();
   if(m_deviceType==DeviceType::GW){
-      Simulator::Schedule(nextBroadcastTime, &Beaconing::BroadcastBeacon, this);
+      Ptr<GatewayLorawanMac> gwMac = m_loraNetDevice->GetMac()->GetObject<GatewayLorawanMac>();
+      GetBeaconTimer ()->AddGateway (gwMac);
   }else if(m_deviceType==DeviceType::ED){
-      Simulator::Schedule(nextBroadcastTime,&Beaconing::ScheduleEndDeviceBeaconReception,this);
+      Ptr<ClassBEndDeviceLorawanMac> classBMac = m_loraNetDevice->
+                                                 GetMac()->
+                                                 GetObject<ClassBEndDeviceLorawanMac>();
+      GetBeaconTimer ()->AddEndDevice (classBMac);
   }
 
 }
@@ -108,20 +129,21 @@ Beaconing::StopApplication (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  if(m_deviceType==DeviceType::GW){
+      Ptr<GatewayLorawanMac> gwMac = m_loraNetDevice->GetMac()->GetObject<GatewayLorawanMac>();
+      GetBeaconTimer ()->RemoveGateway (gwMac);
+  }else if(m_deviceType==DeviceType::ED){
+      Ptr<ClassBEndDeviceLorawanMac> classBMac = m_loraNetDevice->
+                                                 GetMac()->
+                                                 GetObject<ClassBEndDeviceLorawanMac>();
+      GetBeaconTimer ()->RemoveEndDevice (classBMac);
+  }
 }
 
 Time Beaconing::GetNextBeaconBroadcastTime(){
-  double currentTime = Simulator::Now().GetSeconds();
-  double k = static_cast<double>(currentTime)/128;
-  if(k == std::ceil(k)){
-      k = k+1;
-  }else {
-      k = std::ceil(k);
-  }
-  double nextBT = (k*128)+0.0015;
-  double secondsTillNextBT = nextBT - currentTime;
-  NS_LOG_DEBUG("Seconds till next beacon broadcast: "<<secondsTillNextBT);
-  return Seconds(secondsTillNextBT);
+  Time secondsTillNextBT = GetBeaconTimer ()->GetNextBeaconTime () - Simulator::Now ();
+  NS_LOG_DEBUG("Seconds till next beacon broadcast: "<<secondsTillNextBT.GetSeconds ());
+  return secondsTillNextBT;
 }
 
 
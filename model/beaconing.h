@@ -26,6 +26,7 @@
 #include "ns3/nstime.h"
 #include "ns3/attribute.h"
 #include "ns3/lora-tag.h"
+#include "ns3/beacon-timer.h"
 #include "ctime"
 
 namespace ns3 {
@@ -34,6 +35,10 @@ namespace lorawan {
 /**
  * This application sends a beacon from Gateway's NetDevices:
  * Gateway NetDevice -> LoraNetDevice.
+ *
+ * On end devices, it opens the beacon receive window instead. In both cases
+ * the timing of the beacons is left to a BeaconTimer, which can be shared by
+ * all the Beaconing applications of a network.
  */
 class Beaconing : public Application
 {
@@ -60,6 +65,18 @@ public:
 
   DeviceType GetDeviceType();
 
+  /**
+   * Set the timer that drives the beacons of this application.
+   *
+   * If no timer is set, the application creates its own when it starts.
+   */
+  void SetBeaconTimer (Ptr<BeaconTimer> beaconTimer);
+
+  /**
+   * Get the timer that drives the beacons of this application.
+   */
+  Ptr<BeaconTimer> GetBeaconTimer (void);
+
   /**
    * Broadcasts the synchronous beacon defined for class B devices
    */
@@ -77,15 +94,16 @@ public:
 
   Time GetNextBeaconBroadcastTime();
 
+protected:
+  virtual void DoDispose (void);
 
 private:
   DeviceType m_deviceType;
 
 private:
   Ptr<LoraNetDevice> m_loraNetDevice; //!< Pointer to the node's LoraNetDevice
-  void ScheduleEndDeviceBeaconReception();
 
-  void ScheduleEndDevicePingSlotReception();
+  Ptr<BeaconTimer> m_beaconTimer; //!< The timer driving the beacons
 
 };
 
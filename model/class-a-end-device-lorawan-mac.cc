@@ -509,7 +509,7 @@ ClassAEndDeviceLorawanMac::GetNextClassTransmissionDelay (Time waitingTime)
 uint8_t
 ClassAEndDeviceLorawanMac::GetFirstReceiveWindowDataRate (void)
 {
-  return m_replyDataRateMatrix.at (m_dataRate).at (m_rx1DrOffset);
+  return m_regionProfile->GetReplyDataRateMatrix ().at (m_dataRate).at (m_rx1DrOffset);
 }
 
 void
@@ -204,15 +204,9 @@ ClassBEndDeviceLorawanMac::Receive (Ptr<Packet const> packet)
               //Calculate Ping Slot Start time
               double periodicity = 0.96 * std::pow(2,m_pingSlotPeriodicity);
               NS_LOG_DEBUG("Calculated PingSlot periodicity:"<<periodicity);
-              double maxDelay = 128;
-              m_pingSlotEvents.clear();
-              for(int i = 1 ; i < maxDelay ; i++){
-                    if(i*periodicity>128) {
-                        break ;
-                    }
-                    EventId pingSlotEvent = Simulator::Schedule(Seconds(i*periodicity),&ClassBEndDeviceLorawanMac::OpenPingSlotReceiveWindow,this);
-                    m_pingSlotEvents.push_back(pingSlotEvent);
-              }
+              // Only the first slot is scheduled here: each slot schedules
+              // the following one when it opens
+              SchedulePingSlot (Simulator::Now (), periodicity, 1);
           }else{
               NS_LOG_DEBUG("Unspecified broadcast");
           }
@@ -321,6 +315,38 @@ ClassBEndDeviceLorawanMac::TxFinished (Ptr<const Packet> packet)
   m_phy->GetObject<EndDeviceLoraPhy> ()->SwitchToSleep ();
 }
 
+void
+ClassBEndDeviceLorawanMac::SchedulePingSlot (Time beaconTime, double periodicity,
+                                             int slot)
+{
+  NS_LOG_FUNCTION (this << beaconTime << periodicity << slot);
+
+  // Ping slots span the beacon period that follows the beacon
+  double maxDelay = 128;
+  if (slot >= maxDelay || slot * periodicity > maxDelay)
+    {
+      NS_LOG_DEBUG ("No more ping slots in this beacon period");
+      return;
+    }
+
+  // Offsets are computed from the beacon reception time, and not from the
+  // previous slot, so that no rounding error accumulates along the chain
+  Time slotTime = beaconTime + Seconds (slot * periodicity);
+  Simulator::Schedule (slotTime - Simulator::Now (),
+                       &ClassBEndDeviceLorawanMac::OpenScheduledPingSlot, this,
+                       beaconTime, periodicity, slot);
+}
+
+void
+ClassBEndDeviceLorawanMac::OpenScheduledPingSlot (Time beaconTime,
+                                                  double periodicity, int slot)
+{
+  NS_LOG_FUNCTION (this << beaconTime << periodicity << slot);
+
+  SchedulePingSlot (beaconTime, periodicity, slot + 1);
+  OpenPingSlotReceiveWindow ();
+}
+
 void ClassBEndDeviceLorawanMac::OpenPingSlotReceiveWindow()
 {
   NS_LOG_FUNCTION(this);
@@ -724,7 +750,7 @@ ClassBEndDeviceLorawanMac::GetNextClassTransmissionDelay (Time waitingTime)
 uint8_t
 ClassBEndDeviceLorawanMac::GetFirstReceiveWindowDataRate (void)
 {
-  return m_replyDataRateMatrix.at (m_dataRate).at (m_rx1DrOffset);
+  return m_regionProfile->GetReplyDataRateMatrix ().at (m_dataRate).at (m_rx1DrOffset);
 }
 
 void
@@ -771,6 +797,19 @@ double ClassBEndDeviceLorawanMac::GetPingSlotReceiveWindowFrequency()
   return m_pingSlotReceiveWindowFrequency;
 }
 
+void
+ClassBEndDeviceLorawanMac::SetPingSlotPeriodicity (uint8_t periodicity)
+{
+  NS_ASSERT (periodicity <= 7);
+  m_pingSlotPeriodicity = periodicity;
+}
+
+uint8_t
+ClassBEndDeviceLorawanMac::GetPingSlotPeriodicity (void)
+{
+  return m_pingSlotPeriodicity;
+}
+
 void ClassBEndDeviceLorawanMac::SetBeaconReceiveWindowFrequency(double frequencyMHz){
   m_beaconReceiveWindowFrequency = frequencyMHz;
 }
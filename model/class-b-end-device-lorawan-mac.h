@@ -161,6 +161,21 @@ public:
 
   uint8_t GetPingSlotReceiveWindowDataRate();
 
+  /**
+   * Set the ping slot periodicity, as the exponent of the spacing between two
+   * ping slots: slots are 0.96 * 2^periodicity seconds apart.
+   *
+   * \param periodicity The periodicity, from 0 to 7.
+   */
+  void SetPingSlotPeriodicity (uint8_t periodicity);
+
+  /**
+   * Get the ping slot periodicity.
+   *
+   * \return The periodicity, from 0 to 7.
+   */
+  uint8_t GetPingSlotPeriodicity (void);
+
   void SetBeaconReceiveWindowFrequency(double frequencyMhz);
 
   double GetBeaconReceiveWindowFrequency();
@@ -187,6 +202,28 @@ public:
 
 private:
 
+  /**
+   * Schedule the opening of a ping slot receive window.
+   *
+   * Ping slots are scheduled one at a time: when a slot opens, it schedules
+   * the following one, until the end of the beacon period is reached. This
+   * keeps a single pending event per beacon instead of one per slot.
+   *
+   * \param beaconTime The time at which the beacon was received.
+   * \param periodicity The time between two ping slots, in seconds.
+   * \param slot The index of the slot to schedule, starting from 1.
+   */
+  void SchedulePingSlot (Time beaconTime, double periodicity, int slot);
+
+  /**
+   * Schedule the ping slot that follows this one, and open this one.
+   *
+   * \param beaconTime The time at which the beacon was received.
+   * \param periodicity The time between two ping slots, in seconds.
+   * \param slot The index of this slot.
+   */
+  void OpenScheduledPingSlot (Time beaconTime, double periodicity, int slot);
+
   /**
    * The interval between when a packet is done sending and when the first
    * receive window is opened.
@@ -225,8 +262,6 @@ private:
 
   EventId m_beaconReceiveWindow;
 
-  std::vector<EventId> m_pingSlotEvents;
-
   /**
    * The frequency to listen on for the second receive window.
    */
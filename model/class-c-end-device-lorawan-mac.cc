@@ -540,7 +540,7 @@ ClassCEndDeviceLorawanMac::GetNextClassTransmissionDelay (Time waitingTime)
 uint8_t
 ClassCEndDeviceLorawanMac::GetFirstReceiveWindowDataRate (void)
 {
-  return m_replyDataRateMatrix.at (m_dataRate).at (m_rx1DrOffset);
+  return m_regionProfile->GetReplyDataRateMatrix ().at (m_dataRate).at (m_rx1DrOffset);
 }
 
 void
@@ -72,6 +72,7 @@ EndDeviceLoraPhy::EndDeviceLoraPhy () :
   m_frequency (868.1),
   m_sf (7)
 {
+  m_listening = false;
 }
 
 EndDeviceLoraPhy::~EndDeviceLoraPhy ()
@@ -108,6 +109,12 @@ EndDeviceLoraPhy::IsOnFrequency (double frequencyMHz)
   return m_frequency == frequencyMHz;
 }
 
+double
+EndDeviceLoraPhy::GetMinSensitivity (void) const
+{
+  return *std::min_element (sensitivity, sensitivity + 6);
+}
+
 void
 EndDeviceLoraPhy::SetFrequency (double frequencyMHz)
 {
@@ -120,6 +127,7 @@ EndDeviceLoraPhy::SwitchToStandby (void)
   NS_LOG_FUNCTION_NOARGS ();
 
   m_state = STANDBY;
+  m_listening = true;
 
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
@@ -136,6 +144,7 @@ EndDeviceLoraPhy::SwitchToRx (void)
   NS_ASSERT (m_state == STANDBY);
 
   m_state = RX;
+  m_listening = false;
 
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
@@ -152,6 +161,7 @@ EndDeviceLoraPhy::SwitchToTx (double txPowerDbm)
   NS_ASSERT (m_state != RX);
 
   m_state = TX;
+  m_listening = false;
 
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
@@ -168,6 +178,7 @@ EndDeviceLoraPhy::SwitchToSleep (void)
   NS_ASSERT (m_state == STANDBY);
 
   m_state = SLEEP;
+  m_listening = false;
 
   // Notify listeners of the state change
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
@@ -164,6 +164,9 @@ public:
   // Implementation of LoraPhy's pure virtual functions
   virtual bool IsTransmitting (void);
 
+  // Implementation of LoraPhy's pure virtual functions
+  virtual double GetMinSensitivity (void) const;
+
   /**
    * Set the frequency this EndDevice will listen on.
    *
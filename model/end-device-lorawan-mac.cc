@@ -234,7 +234,7 @@ EndDeviceLorawanMac::DoSend (Ptr<Packet> packet)
                    " bytes.");
 
       // Check that MACPayload length is below the allowed maximum
-      if (packet->GetSize () > m_maxAppPayloadForDataRate.at (m_dataRate))
+      if (packet->GetSize () > m_regionProfile->GetMaxAppPayloadForDataRate ().at (m_dataRate))
         {
           NS_LOG_WARN ("Attempting to send a packet larger than the maximum allowed"
                        << " size at this DataRate (DR" << unsigned(m_dataRate) <<
@@ -269,7 +269,12 @@ EndDeviceLorawanMac::DoSend (Ptr<Packet> packet)
       // If this is the first transmission of a confirmed packet, save parameters for the (possible) next retransmissions.
       if (m_mType == LorawanMacHeader::CONFIRMED_DATA_UP)
         {
+          // The copy shares the packet buffer until one of them is modified
           m_retxParams.packet = packet->Copy ();
+          m_retxParams.macHdr = macHdr;
+          m_retxParams.frameHdr = frameHdr;
+          m_retxParams.headersSize = macHdr.GetSerializedSize () +
+            frameHdr.GetSerializedSize ();
           m_retxParams.retxLeft = m_maxNumbTx;
           m_retxParams.waitingAck = true;
           m_retxParams.firstAttempt = Simulator::Now ();
@@ -302,24 +307,35 @@ EndDeviceLorawanMac::DoSend (Ptr<Packet> packet)
       if (m_retxParams.waitingAck)
         {
 
-          // Remove the headers
-          LorawanMacHeader macHdr;
+          // Build the headers for this transmission
           LoraFrameHeader frameHdr;
-          packet->RemoveHeader(macHdr);
-          packet->RemoveHeader(frameHdr);
-
-          // Add the Lora Frame Header to the packet
-          frameHdr = LoraFrameHeader ();
           ApplyNecessaryOptions (frameHdr);
-          packet->AddHeader (frameHdr);
+          LorawanMacHeader macHdr;
+          ApplyNecessaryOptions (macHdr);
 
-          NS_LOG_INFO ("Added frame header of size " << frameHdr.GetSerializedSize () <<
-                       " bytes.");
+          if (CanReuseRetxHeaders (macHdr, frameHdr))
+            {
+              NS_LOG_INFO ("Headers didn't change since the last transmission.");
+            }
+          else
+            {
+              // Replace the old headers, without deserializing them
+              packet->RemoveAtStart (m_retxParams.headersSize);
 
-          // Add the Lorawan Mac header to the packet
-          macHdr = LorawanMacHeader ();
-          ApplyNecessaryOptions (macHdr);
-          packet->AddHeader (macHdr);
+              // Add the Lora Frame Header to the packet
+              packet->AddHeader (frameHdr);
+
+              NS_LOG_INFO ("Added frame header of size " << frameHdr.GetSerializedSize () <<
+                           " bytes.");
+
+              // Add the Lorawan Mac header to the packet
+              packet->AddHeader (macHdr);
+
+              m_retxParams.macHdr = macHdr;
+              m_retxParams.frameHdr = frameHdr;
+              m_retxParams.headersSize = macHdr.GetSerializedSize () +
+                frameHdr.GetSerializedSize ();
+            }
           m_retxParams.retxLeft = m_retxParams.retxLeft - 1;           // decreasing the number of retransmissions
           NS_LOG_DEBUG ("Retransmitting an old packet.");
 
@@ -330,6 +346,22 @@ EndDeviceLorawanMac::DoSend (Ptr<Packet> packet)
 
 }
 
+bool
+EndDeviceLorawanMac::CanReuseRetxHeaders (const LorawanMacHeader &macHdr,
+                                          const LoraFrameHeader &frameHdr) const
+{
+  // MAC commands are only compared through their length, so any of them
+  // forces a rebuild.
+  const LoraFrameHeader &oldFrameHdr = m_retxParams.frameHdr;
+  return macHdr.GetMType () == m_retxParams.macHdr.GetMType ()
+         && frameHdr.GetFOptsLen () == 0
+         && oldFrameHdr.GetFOptsLen () == 0
+         && frameHdr.GetAdr () == oldFrameHdr.GetAdr ()
+         && frameHdr.GetAdrAckReq () == oldFrameHdr.GetAdrAckReq ()
+         && frameHdr.GetAddress () == oldFrameHdr.GetAddress ()
+         && frameHdr.GetFCnt () == oldFrameHdr.GetFCnt ();
+}
+
 void
 EndDeviceLorawanMac::SendToPhy (Ptr<Packet> packet)
 { }
@@ -543,27 +575,11 @@ EndDeviceLorawanMac::GetNextTransmissionDelay (void)
 
   //    Check duty cycle    //
 
-  // Pick a random channel to transmit on
-  std::vector<Ptr<LogicalLoraChannel> > logicalChannels;
-  logicalChannels = m_channelHelper.GetEnabledChannelList ();                 // Use a separate list to do the shuffle
-  //logicalChannels = Shuffle (logicalChannels);
-
+  // Earliest time across every enabled channel
+  Time waitingTime = m_channelHelper.GetMinWaitingTime ();
 
-  Time waitingTime = Time::Max ();
-
-  // Try every channel
-  std::vector<Ptr<LogicalLoraChannel> >::iterator it;
-  for (it = logicalChannels.begin (); it != logicalChannels.end (); ++it)
-    {
-      // Pointer to the current channel
-      Ptr<LogicalLoraChannel> logicalChannel = *it;
-      double frequency = logicalChannel->GetFrequency ();
-
-      waitingTime = std::min (waitingTime, m_channelHelper.GetWaitingTime (logicalChannel));
-
-      NS_LOG_DEBUG ("Waiting time before the next transmission in channel with frequecy " <<
-                    frequency << " is = " << waitingTime.GetSeconds () << ".");
-    }
+  NS_LOG_DEBUG ("Waiting time before the next transmission is = " <<
+                waitingTime.GetSeconds () << ".");
 
   waitingTime = GetNextClassTransmissionDelay (waitingTime);
 
@@ -575,58 +591,32 @@ EndDeviceLorawanMac::GetChannelForTx (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  // Pick a random channel to transmit on
-  std::vector<Ptr<LogicalLoraChannel> > logicalChannels;
-  logicalChannels = m_channelHelper.GetEnabledChannelList ();                 // Use a separate list to do the shuffle
-  logicalChannels = Shuffle (logicalChannels);
-
-  // Try every channel
-  std::vector<Ptr<LogicalLoraChannel> >::iterator it;
-  for (it = logicalChannels.begin (); it != logicalChannels.end (); ++it)
+  // Collect the channels we can send the packet on right away
+  std::size_t nChannels = m_channelHelper.GetNEnabledChannels ();
+  std::vector<std::size_t> available;
+  available.reserve (nChannels);
+  for (std::size_t i = 0; i < nChannels; i++)
     {
-      // Pointer to the current channel
-      Ptr<LogicalLoraChannel> logicalChannel = *it;
-      double frequency = logicalChannel->GetFrequency ();
-
-      NS_LOG_DEBUG ("Frequency of the current channel: " << frequency);
-
-      // Verify that we can send the packet
-      Time waitingTime = m_channelHelper.GetWaitingTime (logicalChannel);
-
-      NS_LOG_DEBUG ("Waiting time for current channel = " <<
-                    waitingTime.GetSeconds ());
-
-      // Send immediately if we can
-      if (waitingTime == Seconds (0))
-        {
-          return *it;
-        }
-      else
+      if (m_channelHelper.GetEnabledChannelWaitingTime (i).IsZero ())
         {
-          NS_LOG_DEBUG ("Packet cannot be immediately transmitted on " <<
-                        "the current channel because of duty cycle limitations.");
+          available.push_back (i);
         }
     }
-  return 0;                 // In this case, no suitable channel was found
-}
-
-
-std::vector<Ptr<LogicalLoraChannel> >
-EndDeviceLorawanMac::Shuffle (std::vector<Ptr<LogicalLoraChannel> > vector)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  int size = vector.size ();
 
-  for (int i = 0; i < size; ++i)
+  if (available.empty ())
     {
-      uint16_t random = std::floor (m_uniformRV->GetValue (0, size));
-      Ptr<LogicalLoraChannel> temp = vector.at (random);
-      vector.at (random) = vector.at (i);
-      vector.at (i) = temp;
+      NS_LOG_DEBUG ("Packet cannot be immediately transmitted on " <<
+                    "any channel because of duty cycle limitations.");
+      return 0;                 // In this case, no suitable channel was found
     }
 
-  return vector;
+  // Pick a random channel among the available ones
+  std::size_t pick = std::floor (m_uniformRV->GetValue (0, available.size ()));
+  pick = std::min (pick, available.size () - 1);
+  Ptr<LogicalLoraChannel> logicalChannel = m_channelHelper.GetEnabledChannel (available[pick]);
+  NS_LOG_DEBUG ("Frequency of the current channel: " <<
+                logicalChannel->GetFrequency ());
+  return logicalChannel;
 }
 
 /////////////////////////
@@ -695,6 +685,12 @@ EndDeviceLorawanMac::SetDeviceAddress (LoraDeviceAddress address)
   NS_LOG_FUNCTION (this << address);
 
   m_address = address;
+
+  // Keep the PHY locking on downlinks for this address
+  if (m_phy && m_phy->HasAddressFilter ())
+    {
+      m_phy->SetAddressFilter (address);
+    }
 }
 
 LoraDeviceAddress
@@ -804,12 +800,12 @@ EndDeviceLorawanMac::OnLinkAdrReq (uint8_t dataRate, uint8_t txPower,
         {
           if (std::find (enabledChannels.begin (), enabledChannels.end (), i) != enabledChannels.end ())
             {
-              m_channelHelper.GetChannelList ().at (i)->SetEnabledForUplink ();
+              m_channelHelper.EnableChannel (i);
               NS_LOG_DEBUG ("Channel " << i << " enabled");
             }
           else
             {
-              m_channelHelper.GetChannelList ().at (i)->DisableForUplink ();
+              m_channelHelper.DisableChannel (i);
               NS_LOG_DEBUG ("Channel " << i << " disabled");
             }
         }
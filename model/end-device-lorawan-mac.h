@@ -350,8 +350,23 @@ protected:
     Ptr<Packet> packet = 0;
     bool waitingAck = false;
     uint8_t retxLeft;
+    LorawanMacHeader macHdr;   //!< The MAC header packet was last sent with
+    LoraFrameHeader frameHdr;  //!< The frame header packet was last sent with
+    uint32_t headersSize = 0;  //!< The serialized size of the two headers
   };
 
+  /**
+   * Check whether the headers of the last transmission of the packet in
+   * m_retxParams can be sent again as they are.
+   *
+   * \param macHdr The MAC header for the next transmission.
+   * \param frameHdr The frame header for the next transmission.
+   * \return True if the headers are the same as the ones already in the
+   * packet.
+   */
+  bool CanReuseRetxHeaders (const LorawanMacHeader &macHdr,
+                            const LoraFrameHeader &frameHdr) const;
+
   /**
    * Enable Data Rate adaptation during the retransmission procedure.
    */
@@ -429,8 +444,8 @@ protected:
   struct LoraRetxParameters m_retxParams;
 
   /**
-   * An uniform random variable, used by the Shuffle method to randomly reorder
-   * the channel list.
+   * An uniform random variable, used to pick a random channel to transmit
+   * on.
    */
   Ptr<UniformRandomVariable> m_uniformRV;
 
@@ -446,13 +461,6 @@ protected:
   TracedCallback<uint8_t, bool, Time, Ptr<Packet> > m_requiredTxCallback;
 
 private:
-  /**
-   * Randomly shuffle a Ptr<LogicalLoraChannel> vector.
-   *
-   * Used to pick a random channel on which to send the packet.
-   */
-  std::vector<Ptr<LogicalLoraChannel> > Shuffle (std::vector<Ptr<LogicalLoraChannel> > vector);
-
   /**
    * Find the minimum waiting time before the next possible transmission.
    */
@@ -126,13 +126,7 @@ EndDeviceStatus::GetCompleteReplyPacket (void)
 
   // Add headers
   m_reply.frameHeader.SetAddress (m_endDeviceAddress);
-  Ptr<Packet> lastPacket = GetLastPacketReceivedFromDevice ()->Copy ();
-  LorawanMacHeader mHdr;
-  LoraFrameHeader fHdr;
-  fHdr.SetAsUplink ();
-  lastPacket->RemoveHeader (mHdr);
-  lastPacket->RemoveHeader (fHdr);
-  m_reply.frameHeader.SetFCnt (fHdr.GetFCnt ());
+  m_reply.frameHeader.SetFCnt (GetLastFrameHeader ().GetFCnt ());
   m_reply.macHeader.SetMType (LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
   replyPacket->AddHeader (m_reply.frameHeader);
   replyPacket->AddHeader (m_reply.macHeader);
@@ -180,6 +174,12 @@ EndDeviceStatus::GetMac (void)
   return m_mac;
 }
 
+LoraDeviceAddress
+EndDeviceStatus::GetEndDeviceAddress (void)
+{
+  return m_endDeviceAddress;
+}
+
 EndDeviceStatus::ReceivedPacketList
 EndDeviceStatus::GetReceivedPacketList ()
 {
@@ -241,24 +241,16 @@ EndDeviceStatus::SetReplyPayload (Ptr<Packet> replyPayload)
 ///////////////////////
 
 void
-EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket, const Address &gwAddress)
+EndDeviceStatus::InsertReceivedPacket (Ptr<const UplinkContext> context)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  // Create a copy of the packet
-  Ptr<Packet> myPacket = receivedPacket->Copy ();
-
-  // Extract the headers
-  LorawanMacHeader macHdr;
-  myPacket->RemoveHeader (macHdr);
-
-  LoraFrameHeader frameHdr;
-  frameHdr.SetAsUplink ();
-  myPacket->RemoveHeader (frameHdr);
+  Ptr<Packet const> receivedPacket = context->GetPacket ();
+  const Address &gwAddress = context->GetGatewayAddress ();
+  const LoraFrameHeader &frameHdr = context->GetFrameHeader ();
 
   // Update current parameters
-  LoraTag tag;
-  myPacket->RemovePacketTag (tag);
+  const LoraTag &tag = context->GetTag ();
 
   if(m_mac->m_rx1_params_rx2_swap){
       SetFirstReceiveWindowFrequency(869.525);
@@ -275,6 +267,7 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket, const A
   info.sf = tag.GetSpreadingFactor ();
   info.frequency = tag.GetFrequency ();
   info.packet = receivedPacket;
+  info.frameHeader = frameHdr;
 
   double rcvPower = tag.GetReceivePower ();
 
@@ -287,12 +280,7 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket, const A
     {
       // Get the frame counter of the current packet to compare it with the
       // newly received one
-      Ptr<Packet> packetCopy = ((*it).first)->Copy ();
-      LorawanMacHeader currentMacHdr;
-      packetCopy->RemoveHeader (currentMacHdr);
-      LoraFrameHeader currentFrameHdr;
-      frameHdr.SetAsUplink ();
-      packetCopy->RemoveHeader (currentFrameHdr);
+      const LoraFrameHeader &currentFrameHdr = it->second.frameHeader;
 
       NS_LOG_DEBUG ("Received packet's frame counter: " << unsigned(frameHdr.GetFCnt ())
                                                         << "\nCurrent packet's frame counter: "
@@ -310,6 +298,7 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket, const A
           gwInfo.receivedTime = Simulator::Now ();
           gwInfo.rxPower = rcvPower;
           gwInfo.gwAddress = gwAddress;
+          gwInfo.gwStatus = context->GetGatewayStatus ();
           gwList.insert (std::pair<Address, PacketInfoPerGw> (gwAddress, gwInfo));
 
           NS_LOG_DEBUG ("Size of gateway list: " << gwList.size ());
@@ -324,6 +313,7 @@ EndDeviceStatus::InsertReceivedPacket (Ptr<Packet const> receivedPacket, const A
       gwInfo.receivedTime = Simulator::Now ();
       gwInfo.rxPower = rcvPower;
       gwInfo.gwAddress = gwAddress;
+      gwInfo.gwStatus = context->GetGatewayStatus ();
       info.gwList.insert (std::pair<Address, PacketInfoPerGw> (gwAddress, gwInfo));
       m_receivedPacketList.push_back (
           std::pair<Ptr<Packet const>, ReceivedPacketInfo> (receivedPacket, info));
@@ -346,6 +336,15 @@ EndDeviceStatus::GetLastReceivedPacketInfo (void)
     }
 }
 
+const LoraFrameHeader &
+EndDeviceStatus::GetLastFrameHeader (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_ASSERT_MSG (!m_receivedPacketList.empty (), "No packet received from this device");
+  return m_receivedPacketList.back ().second.frameHeader;
+}
+
 Ptr<Packet const>
 EndDeviceStatus::GetLastPacketReceivedFromDevice (void)
 {
@@ -414,6 +413,13 @@ EndDeviceStatus::GetPowerGatewayMap (void)
   return gatewayPowers;
 }
 
+const EndDeviceStatus::GatewayList &
+EndDeviceStatus::GetLastGatewayList (void)
+{
+  NS_ASSERT_MSG (!m_receivedPacketList.empty (), "No packet received from this device");
+  return m_receivedPacketList.back ().second.gwList;
+}
+
 std::ostream &
 operator<< (std::ostream &os, const EndDeviceStatus &status)
 {
@@ -29,6 +29,8 @@
 #include "ns3/lora-frame-header.h"
 #include "ns3/pointer.h"
 #include "ns3/lora-frame-header.h"
+#include "ns3/uplink-context.h"
+#include "ns3/gateway-status.h"
 #include <iostream>
 
 namespace ns3 {
@@ -156,6 +158,7 @@ public:
     Address gwAddress;     //!< Address of the gateway that received the packet.
     Time receivedTime;     //!< Time at which the packet was received by this gateway.
     double rxPower;        //!< Reception power of the packet at this gateway.
+    Ptr<GatewayStatus> gwStatus; //!< Status of this gateway, or 0 if unknown.
   };
 
   // List of gateways, with relative information
@@ -168,6 +171,7 @@ public:
   {
     // Members
     Ptr<Packet const> packet = 0;   //!< The received packet
+    LoraFrameHeader frameHeader; //!< The frame header of the packet
     GatewayList gwList;      //!< List of gateways that received this packet.
     uint8_t sf;
     double frequency;
@@ -258,21 +262,36 @@ public:
 
   Ptr<EndDeviceLorawanMac> GetMac (void);
 
+  /**
+   * Get the address of this device.
+   */
+  LoraDeviceAddress GetEndDeviceAddress (void);
+
   //////////////////////
   //  Other methods  //
   //////////////////////
 
   /**
    * Insert a received packet in the packet list.
+   *
+   * \param context The uplink, as received by one of the gateways.
    */
-  void InsertReceivedPacket (Ptr<Packet const> receivedPacket,
-                             const Address& gwAddress);
+  void InsertReceivedPacket (Ptr<const UplinkContext> context);
 
   /**
    * Return the last packet that was received from this device.
    */
   Ptr<Packet const> GetLastPacketReceivedFromDevice (void);
 
+  /**
+   * Return the frame header of the last packet that was received from this
+   * device.
+   *
+   * The header is copied out of the UplinkContext of the first reception,
+   * since the context itself holds this EndDeviceStatus.
+   */
+  const LoraFrameHeader &GetLastFrameHeader (void);
+
   /**
    * Return the information about the last packet that was received from the
    * device.
@@ -308,6 +327,11 @@ public:
    */
   std::map<double, Address> GetPowerGatewayMap (void);
 
+  /**
+   * Return the gateways that received the last packet from this device.
+   */
+  const GatewayList &GetLastGatewayList (void);
+
   struct Reply m_reply; //<! Next reply intended for this device
 
   LoraDeviceAddress m_endDeviceAddress;   //<! The address of this device
@@ -23,6 +23,7 @@
 #include "ns3/lora-tag.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 namespace lorawan {
@@ -123,6 +124,8 @@ GatewayLoraPhy::GetTypeId (void)
 GatewayLoraPhy::GatewayLoraPhy () : m_isTransmitting (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
+
+  m_isGateway = true;
 }
 
 GatewayLoraPhy::~GatewayLoraPhy ()
@@ -139,7 +142,15 @@ GatewayLoraPhy::AddReceptionPath ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  std::size_t index = m_receptionPaths.size ();
   m_receptionPaths.push_back (Create<GatewayLoraPhy::ReceptionPath> ());
+
+  // Mark the new reception path as free
+  if (index % 64 == 0)
+    {
+      m_freeReceptionPaths.push_back (0);
+    }
+  m_freeReceptionPaths[index / 64] |= uint64_t (1) << (index % 64);
 }
 
 void
@@ -154,6 +165,94 @@ GatewayLoraPhy::ResetReceptionPaths (void)
   NS_LOG_FUNCTION (this);
 
   m_receptionPaths.clear ();
+  m_freeReceptionPaths.clear ();
+}
+
+// Get the index of the lowest bit that is set in a non-zero word
+static int32_t
+GetLowestSetBit (uint64_t word)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll (word);
+#else
+  int32_t bit = 0;
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+  return bit;
+#endif
+}
+
+int32_t
+GatewayLoraPhy::GetNextFreeReceptionPath (int32_t index) const
+{
+  for (std::size_t word = index / 64; word < m_freeReceptionPaths.size (); word++)
+    {
+      uint64_t free = m_freeReceptionPaths[word];
+      if (word == std::size_t (index / 64))
+        {
+          // Ignore the reception paths before index
+          free &= ~uint64_t (0) << (index % 64);
+        }
+      if (free != 0)
+        {
+          return int32_t (word * 64) + GetLowestSetBit (free);
+        }
+    }
+  return -1;
+}
+
+int32_t
+GatewayLoraPhy::GetNextOccupiedReceptionPath (int32_t index) const
+{
+  for (std::size_t word = index / 64; word < m_freeReceptionPaths.size (); word++)
+    {
+      uint64_t occupied = ~m_freeReceptionPaths[word];
+      if (word == std::size_t (index / 64))
+        {
+          // Ignore the reception paths before index
+          occupied &= ~uint64_t (0) << (index % 64);
+        }
+      if (word == m_freeReceptionPaths.size () - 1 && m_receptionPaths.size () % 64 != 0)
+        {
+          // Ignore the bits past the last reception path
+          occupied &= (uint64_t (1) << (m_receptionPaths.size () % 64)) - 1;
+        }
+      if (occupied != 0)
+        {
+          return int32_t (word * 64) + GetLowestSetBit (occupied);
+        }
+    }
+  return -1;
+}
+
+void
+GatewayLoraPhy::LockReceptionPath (int32_t index, Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << index << event);
+
+  NS_ASSERT (m_receptionPaths[index]->IsAvailable ());
+
+  m_receptionPaths[index]->LockOnEvent (event);
+  m_freeReceptionPaths[index / 64] &= ~(uint64_t (1) << (index % 64));
+  event->SetReceptionPath (index);
+  m_occupiedReceptionPaths++;
+}
+
+void
+GatewayLoraPhy::FreeReceptionPath (int32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  NS_ASSERT (!m_receptionPaths[index]->IsAvailable ());
+
+  // This also resets all parameters like packet and endReceive call
+  m_receptionPaths[index]->GetEvent ()->SetReceptionPath (-1);
+  m_receptionPaths[index]->Free ();
+  m_freeReceptionPaths[index / 64] |= uint64_t (1) << (index % 64);
+  m_occupiedReceptionPaths--;
 }
 
 void
@@ -178,6 +277,12 @@ GatewayLoraPhy::AddFrequency (double frequencyMHz)
   NS_ASSERT (m_frequencies.size () <= 8);
 }
 
+double
+GatewayLoraPhy::GetMinSensitivity (void) const
+{
+  return *std::min_element (sensitivity, sensitivity + 6);
+}
+
 bool
 GatewayLoraPhy::IsOnFrequency (double frequencyMHz)
 {
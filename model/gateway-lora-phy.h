@@ -29,6 +29,7 @@
 #include "ns3/lora-phy.h"
 #include "ns3/traced-value.h"
 #include <list>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
@@ -67,6 +68,8 @@ public:
 
   virtual bool IsOnFrequency (double frequencyMHz);
 
+  virtual double GetMinSensitivity (void) const;
+
   void SetGatewayTransmissionPriority(bool tx_priority);
 
   bool m_tx_priority = true;
@@ -182,10 +185,49 @@ protected:
   };
 
   /**
-   * A list containing the various parallel receivers that are managed by this
-   * Gateway.
+   * Get the index of the first free reception path at or after a given
+   * index.
+   *
+   * \param index The index to start the search from.
+   * \return The index of the reception path, or -1 if there is none.
+   */
+  int32_t GetNextFreeReceptionPath (int32_t index) const;
+
+  /**
+   * Get the index of the first occupied reception path at or after a given
+   * index.
+   *
+   * \param index The index to start the search from.
+   * \return The index of the reception path, or -1 if there is none.
+   */
+  int32_t GetNextOccupiedReceptionPath (int32_t index) const;
+
+  /**
+   * Lock a free reception path on an event, and store the index of the
+   * reception path in the event.
+   *
+   * \param index The index of the reception path.
+   * \param event The LoraInterferenceHelper Event to lock on.
+   */
+  void LockReceptionPath (int32_t index, Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Free an occupied reception path.
+   *
+   * \param index The index of the reception path.
+   */
+  void FreeReceptionPath (int32_t index);
+
+  /**
+   * The various parallel receivers that are managed by this Gateway.
+   */
+  std::vector<Ptr<ReceptionPath>> m_receptionPaths;
+
+  /**
+   * Bitmap of the reception paths that are available: bit i % 64 of word
+   * i / 64 is set if the reception path with index i is free.
    */
-  std::list<Ptr<ReceptionPath>> m_receptionPaths;
+  std::vector<uint64_t> m_freeReceptionPaths;
 
   /**
    * The number of occupied reception paths.
@@ -78,7 +78,7 @@ GatewayLorawanMac::Send (Ptr<Packet> packet)
 
   if(m_gwDc){
       // Make sure we can transmit this packet
-      if (m_channelHelper.GetWaitingTime(CreateObject<LogicalLoraChannel> (frequency)) > Time(0))
+      if (m_channelHelper.GetWaitingTime (frequency) > Time(0))
       {
           // We cannot send now!
           NS_LOG_WARN ("Trying to send a packet but Duty Cycle won't allow it. Aborting.");
@@ -101,12 +101,10 @@ GatewayLorawanMac::Send (Ptr<Packet> packet)
   NS_LOG_DEBUG ("Duration: " << duration.GetSeconds ());
 
   // Find the channel with the desired frequency
-  double sendingPower = m_channelHelper.GetTxPowerForChannel
-      (CreateObject<LogicalLoraChannel> (frequency));
+  double sendingPower = m_channelHelper.GetTxPowerForFrequency (frequency);
 
   // Add the event to the channelHelper to keep track of duty cycle
-  m_channelHelper.AddEvent (duration, CreateObject<LogicalLoraChannel>
-                              (frequency));
+  m_channelHelper.AddEvent (duration, frequency);
 
   // Send the packet to the PHY layer to send it on the channel
   m_phy->Send (packet, params, frequency, sendingPower);
@@ -133,6 +131,7 @@ GatewayLorawanMac::SendBeacon(){
   double frequency = 869.525;
   tag.SetFrequency(frequency);
   tag.SetDataRate(dataRate);
+  tag.SetDestination (LoraDeviceAddress::GetBroadcast ());
   NS_LOG_DEBUG ("DR: " << unsigned (dataRate));
   NS_LOG_DEBUG ("SF: " << unsigned (GetSfFromDataRate (dataRate)));
   NS_LOG_DEBUG ("BW: " << GetBandwidthFromDataRate (dataRate));
@@ -149,7 +148,7 @@ GatewayLorawanMac::SendBeacon(){
   if(m_gwDc)
   {
       // Make sure we can transmit this packet
-      if (m_channelHelper.GetWaitingTime(CreateObject<LogicalLoraChannel>(frequency)) > Time(0))
+      if (m_channelHelper.GetWaitingTime (frequency) > Time(0))
       {
           // We cannot send now!
           NS_LOG_WARN("Trying to send a packet but Duty Cycle won't allow it. Aborting.");
@@ -171,12 +170,10 @@ GatewayLorawanMac::SendBeacon(){
   NS_LOG_DEBUG ("Duration: " << duration.GetSeconds ());
 
   // Find the channel with the desired frequency
-  double sendingPower = m_channelHelper.GetTxPowerForChannel
-                        (CreateObject<LogicalLoraChannel> (frequency));
+  double sendingPower = m_channelHelper.GetTxPowerForFrequency (frequency);
 
   // Add the event to the channelHelper to keep track of duty cycle
-  m_channelHelper.AddEvent (duration, CreateObject<LogicalLoraChannel>
-                           (frequency));
+  m_channelHelper.AddEvent (duration, frequency);
 
   // Send the packet to the PHY layer to send it on the channel
   m_phy->Send (packet, params, frequency, sendingPower);
@@ -233,8 +230,7 @@ GatewayLorawanMac::GetWaitingTime (double frequency)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  return m_channelHelper.GetWaitingTime (CreateObject<LogicalLoraChannel>
-                                           (frequency));
+  return m_channelHelper.GetWaitingTime (frequency);
 }
 }
 }
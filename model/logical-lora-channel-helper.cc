@@ -21,6 +21,8 @@
 #include "ns3/logical-lora-channel-helper.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <functional>
 
 namespace ns3 {
 namespace lorawan {
@@ -39,6 +41,7 @@ LogicalLoraChannelHelper::GetTypeId (void)
 }
 
 LogicalLoraChannelHelper::LogicalLoraChannelHelper () :
+  m_enabledChannelsDirty (true),
   m_nextAggregatedTransmissionTime (Seconds (0)),
   m_aggregatedDutyCycle (1)
 {
@@ -50,13 +53,13 @@ LogicalLoraChannelHelper::~LogicalLoraChannelHelper ()
   NS_LOG_FUNCTION (this);
 }
 
-std::vector<Ptr <LogicalLoraChannel> >
+std::vector<Ptr<const LogicalLoraChannel> >
 LogicalLoraChannelHelper::GetChannelList (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Make a copy of the channel vector
-  std::vector<Ptr<LogicalLoraChannel> > vector;
+  // Make a read-only copy of the channel vector
+  std::vector<Ptr<const LogicalLoraChannel> > vector;
   vector.reserve (m_channelList.size ());
   std::copy (m_channelList.begin (), m_channelList.end (), std::back_inserter
                (vector));
@@ -65,20 +68,14 @@ LogicalLoraChannelHelper::GetChannelList (void)
 }
 
 
-std::vector<Ptr <LogicalLoraChannel> >
+std::vector<Ptr<const LogicalLoraChannel> >
 LogicalLoraChannelHelper::GetEnabledChannelList (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Make a copy of the channel vector
-  std::vector<Ptr<LogicalLoraChannel> > vector;
-  vector.reserve (m_channelList.size ());
-  std::copy (m_channelList.begin (), m_channelList.end (), std::back_inserter
-               (vector));     // Working on a copy
-
-  std::vector<Ptr <LogicalLoraChannel> > channels;
-  std::vector<Ptr <LogicalLoraChannel> >::iterator it;
-  for (it = vector.begin (); it != vector.end (); it++)
+  std::vector<Ptr<const LogicalLoraChannel> > channels;
+  std::vector<Ptr <LogicalLoraChannel> >::const_iterator it;
+  for (it = m_channelList.begin (); it != m_channelList.end (); it++)
     {
       if ((*it)->IsEnabledForUplink ())
         {
@@ -89,6 +86,163 @@ LogicalLoraChannelHelper::GetEnabledChannelList (void)
   return channels;
 }
 
+std::size_t
+LogicalLoraChannelHelper::GetNEnabledChannels (void)
+{
+  UpdateEnabledChannels ();
+
+  return m_enabledChannels.size ();
+}
+
+Ptr<LogicalLoraChannel>
+LogicalLoraChannelHelper::GetEnabledChannel (std::size_t index)
+{
+  UpdateEnabledChannels ();
+
+  return m_enabledChannels.at (index).channel;
+}
+
+Time
+LogicalLoraChannelHelper::GetEnabledChannelWaitingTime (std::size_t index)
+{
+  UpdateEnabledChannels ();
+
+  // SubBand waiting time
+  Time subBandWaitingTime = m_enabledChannels.at (index).subBand->
+    GetNextTransmissionTime () - Simulator::Now ();
+
+  // Handle case in which waiting time is negative
+  if (subBandWaitingTime.IsNegative ())
+    {
+      return Seconds (0);
+    }
+  return subBandWaitingTime;
+}
+
+void
+LogicalLoraChannelHelper::UpdateEnabledChannels (void)
+{
+  if (!m_enabledChannelsDirty)
+    {
+      return;
+    }
+
+  NS_LOG_FUNCTION (this);
+
+  m_enabledChannels.clear ();
+  m_subBandEnabled.assign (m_subBandList.size (), false);
+  for (const Ptr<LogicalLoraChannel> &channel : m_channelList)
+    {
+      if (channel->IsEnabledForUplink ())
+        {
+          EnabledChannel enabled;
+          enabled.channel = channel;
+          enabled.subBand = GetSubBandFromChannel (channel);
+          m_enabledChannels.push_back (enabled);
+          m_subBandEnabled[FindSubBand (channel->GetFrequency ())] = true;
+        }
+    }
+  m_enabledChannelsDirty = false;
+
+  // Track the SubBands of the enabled channels
+  m_nextTransmissionTimes.clear ();
+  m_trackedTransmissionTimes.assign (m_subBandList.size (), Time::Min ());
+  for (uint32_t i = 0; i < m_subBandList.size (); i++)
+    {
+      if (m_subBandEnabled[i])
+        {
+          PushNextTransmissionTime (i);
+        }
+    }
+}
+
+void
+LogicalLoraChannelHelper::PushNextTransmissionTime (uint32_t index)
+{
+  Time nextTransmissionTime = m_subBandList[index]->GetNextTransmissionTime ();
+
+  // The heap already has an up to date entry for this SubBand
+  if (m_trackedTransmissionTimes[index] == nextTransmissionTime)
+    {
+      return;
+    }
+
+  m_trackedTransmissionTimes[index] = nextTransmissionTime;
+  m_nextTransmissionTimes.push_back (std::make_pair (nextTransmissionTime, index));
+  std::push_heap (m_nextTransmissionTimes.begin (), m_nextTransmissionTimes.end (),
+                  std::greater<std::pair<Time, uint32_t> > ());
+
+  // Superseded entries are dropped when they reach the top of the heap, but
+  // the ones of busy SubBands may stay behind a free SubBand for long: drop
+  // them all once they outnumber the SubBands
+  if (m_nextTransmissionTimes.size () > 2 * m_subBandList.size ())
+    {
+      m_nextTransmissionTimes.erase
+        (std::remove_if (m_nextTransmissionTimes.begin (), m_nextTransmissionTimes.end (),
+                         [this] (const std::pair<Time, uint32_t> &entry)
+                         { return entry.first != m_trackedTransmissionTimes[entry.second]; }),
+        m_nextTransmissionTimes.end ());
+      std::make_heap (m_nextTransmissionTimes.begin (), m_nextTransmissionTimes.end (),
+                      std::greater<std::pair<Time, uint32_t> > ());
+    }
+}
+
+Time
+LogicalLoraChannelHelper::GetNextTransmissionTime (void)
+{
+  UpdateEnabledChannels ();
+
+  while (!m_nextTransmissionTimes.empty ())
+    {
+      std::pair<Time, uint32_t> earliest = m_nextTransmissionTimes.front ();
+      bool superseded = m_trackedTransmissionTimes[earliest.second] != earliest.first;
+      if (!superseded &&
+          m_subBandList[earliest.second]->GetNextTransmissionTime () == earliest.first)
+        {
+          return earliest.first;
+        }
+
+      std::pop_heap (m_nextTransmissionTimes.begin (), m_nextTransmissionTimes.end (),
+                     std::greater<std::pair<Time, uint32_t> > ());
+      m_nextTransmissionTimes.pop_back ();
+
+      // AddEvent already pushed the new time of a superseded entry. Otherwise,
+      // the SubBand was updated without going through AddEvent: replace the
+      // outdated entry.
+      if (!superseded)
+        {
+          PushNextTransmissionTime (earliest.second);
+        }
+    }
+
+  return Time::Max ();
+}
+
+std::size_t
+LogicalLoraChannelHelper::GetNTrackedTransmissionTimes (void)
+{
+  UpdateEnabledChannels ();
+
+  return m_nextTransmissionTimes.size ();
+}
+
+Time
+LogicalLoraChannelHelper::GetMinWaitingTime (void)
+{
+  Time nextTransmissionTime = GetNextTransmissionTime ();
+  if (nextTransmissionTime == Time::Max ())
+    {
+      return Time::Max ();
+    }
+
+  Time waitingTime = nextTransmissionTime - Simulator::Now ();
+  if (waitingTime.IsNegative ())
+    {
+      return Seconds (0);
+    }
+  return waitingTime;
+}
+
 Ptr<SubBand>
 LogicalLoraChannelHelper::GetSubBandFromChannel (Ptr<LogicalLoraChannel>
                                                  channel)
@@ -100,13 +254,10 @@ Ptr<SubBand>
 LogicalLoraChannelHelper::GetSubBandFromFrequency (double frequency)
 {
   // Get the SubBand this frequency belongs to
-  std::list< Ptr< SubBand > >::iterator it;
-  for (it = m_subBandList.begin (); it != m_subBandList.end (); it++)
+  int32_t index = FindSubBand (frequency);
+  if (index >= 0)
     {
-      if ((*it)->BelongsToSubBand (frequency))
-        {
-          return *it;
-        }
+      return m_subBandList[index];
     }
 
   NS_LOG_ERROR ("Requested frequency: " << frequency);
@@ -115,6 +266,25 @@ LogicalLoraChannelHelper::GetSubBandFromFrequency (double frequency)
   return 0;     // If no SubBand is found, return 0
 }
 
+int32_t
+LogicalLoraChannelHelper::FindSubBand (double frequency)
+{
+  // Go back from the last SubBand starting below the frequency
+  auto it = std::upper_bound (m_subBandList.begin (), m_subBandList.end (), frequency,
+                              [] (double f, const Ptr<SubBand> &subBand)
+                              { return f < subBand->GetFirstFrequency (); });
+  while (it != m_subBandList.begin ())
+    {
+      it--;
+      if ((*it)->BelongsToSubBand (frequency))
+        {
+          return int32_t (it - m_subBandList.begin ());
+        }
+    }
+
+  return -1;
+}
+
 void
 LogicalLoraChannelHelper::AddChannel (double frequency)
 {
@@ -125,6 +295,8 @@ LogicalLoraChannelHelper::AddChannel (double frequency)
 
   // Add it to the list
   m_channelList.push_back (channel);
+  m_sharedChannels.push_back (false);
+  m_enabledChannelsDirty = true;
 
   NS_LOG_DEBUG ("Added a channel. Current number of channels in list is " <<
                 m_channelList.size ());
@@ -137,6 +309,18 @@ LogicalLoraChannelHelper::AddChannel (Ptr<LogicalLoraChannel> logicalChannel)
 
   // Add it to the list
   m_channelList.push_back (logicalChannel);
+  m_sharedChannels.push_back (false);
+  m_enabledChannelsDirty = true;
+}
+
+void
+LogicalLoraChannelHelper::AddSharedChannel (Ptr<LogicalLoraChannel> logicalChannel)
+{
+  NS_LOG_FUNCTION (this << logicalChannel);
+
+  m_channelList.push_back (logicalChannel);
+  m_sharedChannels.push_back (true);
+  m_enabledChannelsDirty = true;
 }
 
 void
@@ -147,6 +331,8 @@ LogicalLoraChannelHelper::SetChannel (uint8_t chIndex,
   NS_LOG_FUNCTION (this << chIndex << logicalChannel);
 
   m_channelList.at (chIndex) = logicalChannel;
+  m_sharedChannels.at (chIndex) = false;
+  m_enabledChannelsDirty = true;
 }
 
 void
@@ -156,10 +342,8 @@ LogicalLoraChannelHelper::AddSubBand (double firstFrequency,
 {
   NS_LOG_FUNCTION (this << firstFrequency << lastFrequency);
 
-  Ptr<SubBand> subBand = Create<SubBand> (firstFrequency, lastFrequency,
-                                          dutyCycle, maxTxPowerDbm);
-
-  m_subBandList.push_back (subBand);
+  AddSubBand (Create<SubBand> (firstFrequency, lastFrequency, dutyCycle,
+                               maxTxPowerDbm));
 }
 
 void
@@ -167,7 +351,13 @@ LogicalLoraChannelHelper::AddSubBand (Ptr<SubBand> subBand)
 {
   NS_LOG_FUNCTION (this << subBand);
 
-  m_subBandList.push_back (subBand);
+  // Keep the list sorted, after the SubBands with the same first frequency
+  auto it = std::upper_bound (m_subBandList.begin (), m_subBandList.end (),
+                              subBand->GetFirstFrequency (),
+                              [] (double f, const Ptr<SubBand> &other)
+                              { return f < other->GetFirstFrequency (); });
+  m_subBandList.insert (it, subBand);
+  m_enabledChannelsDirty = true;
 }
 
 void
@@ -180,7 +370,10 @@ LogicalLoraChannelHelper::RemoveChannel (Ptr<LogicalLoraChannel> logicalChannel)
       Ptr<LogicalLoraChannel> currentChannel = *it;
       if (currentChannel == logicalChannel)
         {
+          m_sharedChannels.erase (m_sharedChannels.begin () +
+                                  (it - m_channelList.begin ()));
           m_channelList.erase (it);
+          m_enabledChannelsDirty = true;
           return;
         }
     }
@@ -206,8 +399,16 @@ LogicalLoraChannelHelper::GetWaitingTime (Ptr<LogicalLoraChannel> channel)
 {
   NS_LOG_FUNCTION (this << channel);
 
+  return GetWaitingTime (channel->GetFrequency ());
+}
+
+Time
+LogicalLoraChannelHelper::GetWaitingTime (double frequency)
+{
+  NS_LOG_FUNCTION (this << frequency);
+
   // SubBand waiting time
-  Time subBandWaitingTime = GetSubBandFromChannel (channel)->
+  Time subBandWaitingTime = GetSubBandFromFrequency (frequency)->
     GetNextTransmissionTime () -
     Simulator::Now ();
 
@@ -226,7 +427,17 @@ LogicalLoraChannelHelper::AddEvent (Time duration,
 {
   NS_LOG_FUNCTION (this << duration << channel);
 
-  Ptr<SubBand> subBand = GetSubBandFromChannel (channel);
+  AddEvent (duration, channel->GetFrequency ());
+}
+
+void
+LogicalLoraChannelHelper::AddEvent (Time duration, double frequency)
+{
+  NS_LOG_FUNCTION (this << duration << frequency);
+
+  int32_t index = FindSubBand (frequency);
+  NS_ABORT_MSG_IF (index < 0, "Logical channel doesn't belong to a known SubBand");
+  Ptr<SubBand> subBand = m_subBandList[index];
 
   double dutyCycle = subBand->GetDutyCycle ();
   double timeOnAir = duration.GetSeconds ();
@@ -235,6 +446,12 @@ LogicalLoraChannelHelper::AddEvent (Time duration,
   subBand->SetNextTransmissionTime (Simulator::Now () + Seconds
                                       (timeOnAir / dutyCycle - timeOnAir));
 
+  // The heap is rebuilt when the enabled channels change
+  if (!m_enabledChannelsDirty && m_subBandEnabled[index])
+    {
+      PushNextTransmissionTime (index);
+    }
+
   // Computation of necessary aggregate waiting time
   m_nextAggregatedTransmissionTime = Simulator::Now () + Seconds
       (timeOnAir / m_aggregatedDutyCycle - timeOnAir);
@@ -254,15 +471,19 @@ LogicalLoraChannelHelper::GetTxPowerForChannel (Ptr<LogicalLoraChannel>
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  // Get the maxTxPowerDbm from the SubBand this channel is in
-  std::list< Ptr< SubBand > >::iterator it;
-  for (it = m_subBandList.begin (); it != m_subBandList.end (); it++)
+  return GetTxPowerForFrequency (logicalChannel->GetFrequency ());
+}
+
+double
+LogicalLoraChannelHelper::GetTxPowerForFrequency (double frequency)
+{
+  NS_LOG_FUNCTION (this << frequency);
+
+  // Get the maxTxPowerDbm from the SubBand this frequency is in
+  int32_t index = FindSubBand (frequency);
+  if (index >= 0)
     {
-      // Check whether this channel is in this SubBand
-      if ((*it)->BelongsToSubBand (logicalChannel->GetFrequency ()))
-        {
-          return (*it)->GetMaxTxPowerDbm ();
-        }
+      return m_subBandList[index]->GetMaxTxPowerDbm ();
     }
   NS_ABORT_MSG ("Logical channel doesn't belong to a known SubBand");
 
@@ -274,7 +495,39 @@ LogicalLoraChannelHelper::DisableChannel (int index)
 {
   NS_LOG_FUNCTION (this << index);
 
-  m_channelList.at (index)->DisableForUplink ();
+  GetChannelForUpdate (index)->DisableForUplink ();
+  m_enabledChannelsDirty = true;
+}
+
+void
+LogicalLoraChannelHelper::EnableChannel (int index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  GetChannelForUpdate (index)->SetEnabledForUplink ();
+  m_enabledChannelsDirty = true;
+}
+
+Ptr<LogicalLoraChannel>
+LogicalLoraChannelHelper::GetChannelForUpdate (int index)
+{
+  Ptr<LogicalLoraChannel> channel = m_channelList.at (index);
+  if (m_sharedChannels.at (index))
+    {
+      NS_LOG_DEBUG ("Copying shared channel " << index);
+
+      Ptr<LogicalLoraChannel> copy = CreateObject<LogicalLoraChannel>
+          (channel->GetFrequency (), channel->GetMinimumDataRate (),
+          channel->GetMaximumDataRate ());
+      if (!channel->IsEnabledForUplink ())
+        {
+          copy->DisableForUplink ();
+        }
+      m_channelList.at (index) = copy;
+      m_sharedChannels.at (index) = false;
+      channel = copy;
+    }
+  return channel;
 }
 }
 }
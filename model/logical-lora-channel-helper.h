@@ -29,6 +29,7 @@
 #include <list>
 #include <iterator>
 #include <vector>
+#include <utility>
 
 namespace ns3 {
 namespace lorawan {
@@ -72,6 +73,19 @@ public:
    */
   Time GetWaitingTime (Ptr<LogicalLoraChannel> channel);
 
+  /**
+   * Get the time it is necessary to wait for before transmitting on a given
+   * frequency.
+   *
+   * This is equivalent to GetWaitingTime, without the need to create a
+   * LogicalLoraChannel for the frequency.
+   *
+   * \param frequency The frequency we want to know the waiting time for.
+   * \return A Time instance containing the waiting time before transmission is
+   * allowed on the frequency.
+   */
+  Time GetWaitingTime (double frequency);
+
   /**
    * Register the transmission of a packet.
    *
@@ -80,12 +94,24 @@ public:
    */
   void AddEvent (Time duration, Ptr<LogicalLoraChannel> channel);
 
+  /**
+   * Register the transmission of a packet.
+   *
+   * \param duration The duration of the transmission event.
+   * \param frequency The frequency the transmission was made on.
+   */
+  void AddEvent (Time duration, double frequency);
+
   /**
    * Get the list of LogicalLoraChannels currently registered on this helper.
    *
+   * Channels added with AddSharedChannel may be shared with other helpers,
+   * so they are only exposed read-only: use EnableChannel and DisableChannel
+   * to change them.
+   *
    * \return A list of the managed channels.
    */
-  std::vector<Ptr<LogicalLoraChannel> > GetChannelList (void);
+  std::vector<Ptr<const LogicalLoraChannel> > GetChannelList (void);
 
   /**
    * Get the list of LogicalLoraChannels currently registered on this helper
@@ -93,7 +119,63 @@ public:
    *
    * \return A list of the managed channels enabled for Uplink transmission.
    */
-  std::vector<Ptr<LogicalLoraChannel> > GetEnabledChannelList (void);
+  std::vector<Ptr<const LogicalLoraChannel> > GetEnabledChannelList (void);
+
+  /**
+   * Get the number of channels enabled for Uplink transmission.
+   *
+   * \return The number of enabled channels.
+   */
+  std::size_t GetNEnabledChannels (void);
+
+  /**
+   * Get a channel enabled for Uplink transmission.
+   *
+   * \param index The index of the channel among the enabled ones, in the
+   * order of the channel list.
+   * \return The channel.
+   */
+  Ptr<LogicalLoraChannel> GetEnabledChannel (std::size_t index);
+
+  /**
+   * Get the time it is necessary to wait for before transmitting on a
+   * channel enabled for Uplink transmission.
+   *
+   * This is equivalent to GetWaitingTime, but the SubBand of the channel is
+   * not searched for.
+   *
+   * \param index The index of the channel among the enabled ones.
+   * \return The waiting time before transmission is allowed on the channel.
+   */
+  Time GetEnabledChannelWaitingTime (std::size_t index);
+
+  /**
+   * Get the earliest time at which transmission will be allowed on at least
+   * one of the channels enabled for Uplink transmission.
+   *
+   * \remark This function does not take into account aggregate waiting time.
+   *
+   * \return The earliest transmission time, which may be in the past, or
+   * Time::Max () if no channel is enabled.
+   */
+  Time GetNextTransmissionTime (void);
+
+  /**
+   * Get the number of entries used to track the next transmission times of
+   * the SubBands, including the outdated ones that were not dropped yet.
+   *
+   * \return The number of entries.
+   */
+  std::size_t GetNTrackedTransmissionTimes (void);
+
+  /**
+   * Get the time it is necessary to wait for before transmitting on at least
+   * one of the channels enabled for Uplink transmission.
+   *
+   * \return The shortest waiting time among the enabled channels, or
+   * Time::Max () if no channel is enabled.
+   */
+  Time GetMinWaitingTime (void);
 
   /**
    * Add a new channel to the list.
@@ -109,6 +191,15 @@ public:
    */
   void AddChannel (Ptr<LogicalLoraChannel> logicalChannel);
 
+  /**
+   * Add a channel that is shared with other helpers to the list.
+   *
+   * The channel is copied before being modified by this helper.
+   *
+   * \param logicalChannel A pointer to the channel to add to the list.
+   */
+  void AddSharedChannel (Ptr<LogicalLoraChannel> logicalChannel);
+
   /**
    * Set a new channel at a fixed index.
    *
@@ -152,6 +243,16 @@ public:
    */
   double GetTxPowerForChannel (Ptr<LogicalLoraChannel> logicalChannel);
 
+  /**
+   * Returns the maximum transmission power [dBm] that is allowed on a
+   * frequency.
+   *
+   * \param frequency The frequency for which to check the maximum allowed
+   * transmission power.
+   * \return The power in dBm.
+   */
+  double GetTxPowerForFrequency (double frequency);
+
   /**
    * Get the SubBand a channel belongs to.
    *
@@ -175,11 +276,90 @@ public:
    */
   void DisableChannel (int index);
 
+  /**
+   * Enable the channel at a specified index.
+   *
+   * \param index The index of the channel to enable.
+   */
+  void EnableChannel (int index);
+
 private:
   /**
-   * A list of the SubBands that are currently registered within this helper.
+   * A channel enabled for Uplink transmission, with the SubBand it belongs
+   * to.
+   */
+  struct EnabledChannel
+  {
+    Ptr<LogicalLoraChannel> channel; //!< The channel
+    Ptr<SubBand> subBand;            //!< The SubBand of the channel
+  };
+
+  /**
+   * Get the index in m_subBandList of the SubBand a frequency belongs to.
+   *
+   * \param frequency The frequency we want to check.
+   * \return The index of the SubBand, or -1 if the frequency is outside any
+   * known SubBand.
+   */
+  int32_t FindSubBand (double frequency);
+
+  /**
+   * Add the next transmission time of a SubBand to m_nextTransmissionTimes.
+   *
+   * \param index The index of the SubBand in m_subBandList.
+   */
+  void PushNextTransmissionTime (uint32_t index);
+
+  /**
+   * Get the channel at a specified index, copying it first if it is shared.
+   *
+   * \param index The index of the channel to modify.
+   * \return A channel that is owned by this helper only.
    */
-  std::list<Ptr <SubBand> > m_subBandList;
+  Ptr<LogicalLoraChannel> GetChannelForUpdate (int index);
+
+  /**
+   * Fill m_enabledChannels, if channels were enabled or disabled since it was
+   * last filled.
+   */
+  void UpdateEnabledChannels (void);
+
+  /**
+   * The channels enabled for Uplink transmission, in the order of
+   * m_channelList.
+   */
+  std::vector<EnabledChannel> m_enabledChannels;
+
+  /**
+   * Whether m_enabledChannels needs to be filled again.
+   */
+  bool m_enabledChannelsDirty;
+
+  /**
+   * Whether each SubBand in m_subBandList contains a channel enabled for
+   * Uplink transmission.
+   */
+  std::vector<bool> m_subBandEnabled;
+
+  /**
+   * A min-heap of the next transmission times of the SubBands containing an
+   * enabled channel, with the index of the SubBand. An entry is outdated if
+   * it was superseded by a newer one, or if its time differs from the current
+   * next transmission time of the SubBand.
+   */
+  std::vector<std::pair<Time, uint32_t> > m_nextTransmissionTimes;
+
+  /**
+   * The time of the newest entry of each SubBand in m_nextTransmissionTimes,
+   * or Time::Min () if it has none. Older entries are superseded.
+   */
+  std::vector<Time> m_trackedTransmissionTimes;
+
+  /**
+   * The SubBands that are currently registered within this helper, sorted by
+   * their first frequency.
+   */
+  std::vector<Ptr <SubBand> > m_subBandList;
 
   /**
    * A vector of the LogicalLoraChannels that are currently registered within
@@ -188,6 +368,11 @@ private:
    */
   std::vector<Ptr <LogicalLoraChannel> > m_channelList;
 
+  /**
+   * Whether each channel in m_channelList is shared with other helpers.
+   */
+  std::vector<bool> m_sharedChannels;
+
   Time m_nextAggregatedTransmissionTime; //!< The next time at which
   //!transmission will be possible
   //!according to the aggregated
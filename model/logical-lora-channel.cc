@@ -87,13 +87,13 @@ LogicalLoraChannel::SetMaximumDataRate (uint8_t maxDataRate)
 }
 
 uint8_t
-LogicalLoraChannel::GetMinimumDataRate (void)
+LogicalLoraChannel::GetMinimumDataRate (void) const
 {
   return m_minDataRate;
 }
 
 uint8_t
-LogicalLoraChannel::GetMaximumDataRate (void)
+LogicalLoraChannel::GetMaximumDataRate (void) const
 {
   return m_maxDataRate;
 }
@@ -111,7 +111,7 @@ LogicalLoraChannel::DisableForUplink (void)
 }
 
 bool
-LogicalLoraChannel::IsEnabledForUplink (void)
+LogicalLoraChannel::IsEnabledForUplink (void) const
 {
   return m_enabledForUplink;
 }
@@ -85,12 +85,12 @@ public:
   /**
    * Get the minimum Data Rate that is allowed on this channel.
    */
-  uint8_t GetMinimumDataRate (void);
+  uint8_t GetMinimumDataRate (void) const;
 
   /**
    * Get the maximum Data Rate that is allowed on this channel.
    */
-  uint8_t GetMaximumDataRate (void);
+  uint8_t GetMaximumDataRate (void) const;
 
   /**
    * Set this channel as enabled for uplink.
@@ -105,7 +105,7 @@ public:
   /**
    * Test whether this channel is marked as enabled for uplink.
    */
-  bool IsEnabledForUplink (void);
+  bool IsEnabledForUplink (void) const;
 
 private:
   /**
@@ -21,12 +21,16 @@
 #include "ns3/lora-channel.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/gateway-lora-phy.h"
+#include "ns3/lora-tag.h"
 #include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 namespace lorawan {
@@ -52,6 +56,100 @@ LoraChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&LoraChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCulling",
+                   "Whether to skip the delivery of transmissions to receivers "
+                   "that can neither receive them nor be interfered by them",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_receiverCulling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("InterferenceMargin",
+                   "Margin [dB] below a receiver's best-case sensitivity under "
+                   "which a transmission is culled when ReceiverCulling is enabled",
+                   DoubleValue (30),
+                   MakeDoubleAccessor (&LoraChannel::m_interferenceMarginDb),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxRange",
+                   "Distance [m] beyond which PHYs are never notified of a "
+                   "transmission. If positive, the channel keeps a grid index "
+                   "of the PHY positions, so that only nearby PHYs are visited "
+                   "for each transmission. Zero disables the range limit.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&LoraChannel::SetMaxRange,
+                                       &LoraChannel::GetMaxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("StaticTopology",
+                   "Whether PHYs can be assumed not to move, so that the path "
+                   "loss and propagation delay between each pair of PHYs can be "
+                   "computed once and reused for all transmissions. The "
+                   "propagation loss model must be deterministic. Cached values "
+                   "involving a PHY are updated whenever its mobility model "
+                   "reports a course change.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::SetStaticTopology,
+                                        &LoraChannel::GetStaticTopology),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxPathLoss",
+                   "Path loss [dB] above which a link is not stored when "
+                   "StaticTopology is enabled, and its receiver is not notified "
+                   "of transmissions. Zero disables the cutoff.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&LoraChannel::SetMaxPathLoss,
+                                       &LoraChannel::GetMaxPathLoss),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("BatchedDelivery",
+                   "Whether to notify all receivers of a transmission whose "
+                   "propagation delays fall in the same DelayResolution bucket "
+                   "with a single event, instead of scheduling one event per "
+                   "receiver. In this mode, the PacketSent trace source is "
+                   "fired once per transmission.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_batchedDelivery),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DelayResolution",
+                   "Width of the propagation delay buckets used by batched "
+                   "delivery. Receivers in a bucket are notified after the "
+                   "shortest delay in the bucket. Zero only groups receivers "
+                   "with identical delays.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&LoraChannel::m_delayResolution),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("SharedInterference",
+                   "Whether the channel keeps a single record of each "
+                   "transmission, that PHYs query to evaluate interference, "
+                   "instead of each PHY storing its own copy of every "
+                   "transmission it hears. Interference is evaluated using "
+                   "link budgets stored as with StaticTopology, so the loss "
+                   "model must be deterministic.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_sharedInterference),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LazyReception",
+                   "Whether transmissions are only delivered to PHYs that can "
+                   "lock on them, skipping for instance end devices that are "
+                   "sleeping or transmitting. Since these PHYs do not see the "
+                   "transmissions, this implies SharedInterference.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_lazyReception),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RoleAwareDelivery",
+                   "Whether transmissions are only delivered for reception to "
+                   "PHYs of the other role, i.e., uplinks to gateways and "
+                   "downlinks to end devices. PHYs with the same role as the "
+                   "sender only register the transmission as interference, "
+                   "or are skipped if interference is shared.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_roleAwareDelivery),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AddressFiltering",
+                   "Whether downlinks are only delivered for reception to PHYs "
+                   "with no address filter, or whose filter accepts the "
+                   "destination address of the downlink. Other PHYs only "
+                   "register the transmission as interference, or are skipped "
+                   "if interference is shared, so the downlink never reaches "
+                   "their MAC layer.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LoraChannel::m_addressFiltering),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PacketSent",
                      "Trace source fired whenever a packet goes out on the channel",
                      MakeTraceSourceAccessor (&LoraChannel::m_packetSent),
@@ -59,19 +157,46 @@ LoraChannel::GetTypeId (void)
   return tid;
 }
 
-LoraChannel::LoraChannel ()
+LoraChannel::LoraChannel () :
+  m_receiverCulling (false),
+  m_interferenceMarginDb (30),
+  m_maxRange (0),
+  m_staticTopology (false),
+  m_maxPathLossDb (0),
+  m_batchedDelivery (false),
+  m_delayResolution (Seconds (0)),
+  m_sharedInterference (false),
+  m_lazyReception (false),
+  m_roleAwareDelivery (false),
+  m_addressFiltering (false),
+  m_maxLedgerDuration (Seconds (0)),
+  m_indexDirty (true)
 {
 }
 
 LoraChannel::~LoraChannel ()
 {
+  DisconnectMobility ();
   m_phyList.clear ();
 }
 
 LoraChannel::LoraChannel (Ptr<PropagationLossModel> loss,
                           Ptr<PropagationDelayModel> delay) :
   m_loss (loss),
-  m_delay (delay)
+  m_delay (delay),
+  m_receiverCulling (false),
+  m_interferenceMarginDb (30),
+  m_maxRange (0),
+  m_staticTopology (false),
+  m_maxPathLossDb (0),
+  m_batchedDelivery (false),
+  m_delayResolution (Seconds (0)),
+  m_sharedInterference (false),
+  m_lazyReception (false),
+  m_roleAwareDelivery (false),
+  m_addressFiltering (false),
+  m_maxLedgerDuration (Seconds (0)),
+  m_indexDirty (true)
 {
 }
 
@@ -82,6 +207,9 @@ LoraChannel::Add (Ptr<LoraPhy> phy)
 
   // Add the new phy to the vector
   m_phyList.push_back (phy);
+
+  // The position of the new PHY may not be known yet: index it lazily
+  m_indexDirty = true;
 }
 
 void
@@ -91,6 +219,9 @@ LoraChannel::Remove (Ptr<LoraPhy> phy)
 
   // Remove the phy from the vector
   m_phyList.erase (find (m_phyList.begin (), m_phyList.end (), phy));
+
+  // Indices of the following PHYs shifted
+  m_indexDirty = true;
 }
 
 std::size_t
@@ -118,66 +249,214 @@ LoraChannel::Send (Ptr< LoraPhy > sender, Ptr< Packet > packet,
 
   NS_ASSERT (senderMobility != 0);     // Make sure it's available
 
-  NS_LOG_INFO ("Starting cycle over all " << m_phyList.size () << " PHYs");
-  NS_LOG_INFO ("Sender mobility: " << senderMobility->GetPosition ());
+  if (m_indexDirty && (m_maxRange > 0 || m_staticTopology))
+    {
+      RebuildIndex ();
+    }
 
-  // Cycle over all registered PHYs
-  uint32_t j = 0;
-  std::vector<Ptr<LoraPhy> >::const_iterator i;
-  for (i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  if (IsInterferenceShared ())
     {
-      // Do not deliver to the sender (*i is the current PHY)
-      if (sender != (*i))
-        {
-          // Get the receiver's mobility model
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->
-            GetObject<MobilityModel> ();
+      RecordTransmission (sender, packet, txPowerDbm, txParams.sf, duration,
+                          frequencyMHz);
+    }
 
-          NS_LOG_INFO ("Receiver mobility: " <<
-                       receiverMobility->GetPosition ());
+  // Read the destination once, instead of letting each PHY find out
+  LoraDeviceAddress destinationAddress;
+  const LoraDeviceAddress *destination = 0;
+  if (GetDestination (sender, packet, destinationAddress))
+    {
+      destination = &destinationAddress;
+    }
 
-          // Compute delay using the delay model
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  if (m_staticTopology)
+    {
+      // Reuse the link budgets towards the PHYs reached by this sender
+      const std::vector<LinkBudget> &links = GetLinkBudgets (sender);
 
-          // Compute received power using the loss model
-          double rxPowerDbm = GetRxPower (txPowerDbm, senderMobility,
-                                          receiverMobility);
+      NS_LOG_INFO ("Starting cycle over " << links.size () << " of " <<
+                   m_phyList.size () << " PHYs using stored link budgets");
+
+      for (const LinkBudget &link : links)
+        {
+          if (m_lazyReception && !m_phyList[link.receiver]->IsListening ())
+            {
+              continue;
+            }
+
+          // The shared record already accounts for the interference
+          bool interferenceOnly = IsInterferenceOnly (sender, m_phyList[link.receiver],
+                                                      destination);
+          if (interferenceOnly && IsInterferenceShared ())
+            {
+              continue;
+            }
+
+          double rxPowerDbm = txPowerDbm + link.gainDb;
 
           NS_LOG_DEBUG ("Propagation: txPower=" << txPowerDbm <<
                         "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) <<
-                        "m, delay=" << delay);
+                        "delay=" << link.delay);
 
-          // Get the id of the destination PHY to correctly format the context
-          Ptr<NetDevice> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode = 0;
-          if (dstNetDevice != 0)
+          ScheduleReception (link.receiver, packet, rxPowerDbm, link.delay,
+                             txParams.sf, duration, frequencyMHz,
+                             interferenceOnly);
+        }
+    }
+  else
+    {
+      // Gather the PHYs that can be reached by this transmission
+      GatherCandidates (senderMobility->GetPosition ());
+
+      NS_LOG_INFO ("Starting cycle over " << m_candidates.size () << " of " <<
+                   m_phyList.size () << " PHYs");
+      NS_LOG_INFO ("Sender mobility: " << senderMobility->GetPosition ());
+
+      // Cycle over the candidate PHYs
+      for (uint32_t j : m_candidates)
+        {
+          // Do not deliver to the sender, nor to PHYs that cannot lock on
+          // the packet if reception is lazy
+          if (m_phyList[j] == sender
+              || (m_lazyReception && !m_phyList[j]->IsListening ()))
             {
-              NS_LOG_INFO ("Getting node index from NetDevice, since it exists");
-              dstNode = dstNetDevice->GetNode ()->GetId ();
-              NS_LOG_DEBUG ("dstNode = " << dstNode);
+              continue;
             }
-          else
+
+          // The shared record already accounts for the interference
+          bool interferenceOnly = IsInterferenceOnly (sender, m_phyList[j],
+                                                      destination);
+          if (interferenceOnly && IsInterferenceShared ())
             {
-              NS_LOG_INFO ("No net device connected to the PHY, using context 0");
+              continue;
             }
 
-          // Create the parameters object based on the calculations above
-          LoraChannelParameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.sf = txParams.sf;
-          parameters.duration = duration;
-          parameters.frequencyMHz = frequencyMHz;
+          ComputeAndScheduleReception (j, senderMobility, packet, txPowerDbm,
+                                       txParams.sf, duration, frequencyMHz,
+                                       interferenceOnly);
+        }
+    }
 
-          // Schedule the receive event
-          NS_LOG_INFO ("Scheduling reception of the packet");
-          Simulator::ScheduleWithContext (dstNode, delay, &LoraChannel::Receive,
-                                          this, j, packet, parameters);
+  if (m_batchedDelivery)
+    {
+      LoraChannelParameters parameters;
+      parameters.sf = txParams.sf;
+      parameters.duration = duration;
+      parameters.frequencyMHz = frequencyMHz;
+      ScheduleBatches (packet, parameters);
 
-          // Fire the trace source for sent packet
-          m_packetSent (packet);
-        }
+      // Fire the trace source for sent packet
+      m_packetSent (packet);
+    }
+}
+
+void
+LoraChannel::ComputeAndScheduleReception (uint32_t j,
+                                          Ptr<MobilityModel> senderMobility,
+                                          Ptr<Packet> packet, double txPowerDbm,
+                                          uint8_t sf, Time duration,
+                                          double frequencyMHz,
+                                          bool interferenceOnly) const
+{
+  NS_LOG_FUNCTION (this << j << senderMobility << packet << txPowerDbm <<
+                   unsigned (sf) << duration << frequencyMHz <<
+                   interferenceOnly);
+
+  // Get the receiver's mobility model
+  Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->
+    GetObject<MobilityModel> ();
+
+  NS_LOG_INFO ("Receiver mobility: " << receiverMobility->GetPosition ());
+
+  // Receivers in neighboring grid cells may still be out of range
+  if (m_maxRange > 0 &&
+      senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+    {
+      NS_LOG_DEBUG ("Receiver out of range");
+      return;
+    }
+
+  // Compute delay using the delay model
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+
+  // Compute received power using the loss model
+  double rxPowerDbm = GetRxPower (txPowerDbm, senderMobility, receiverMobility);
+
+  NS_LOG_DEBUG ("Propagation: txPower=" << txPowerDbm <<
+                "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) <<
+                "m, delay=" << delay);
+
+  ScheduleReception (j, packet, rxPowerDbm, delay, sf, duration, frequencyMHz,
+                     interferenceOnly);
+}
+
+void
+LoraChannel::ScheduleReception (uint32_t j, Ptr<Packet> packet,
+                                double rxPowerDbm, Time delay, uint8_t sf,
+                                Time duration, double frequencyMHz,
+                                bool interferenceOnly) const
+{
+  NS_LOG_FUNCTION (this << j << packet << rxPowerDbm << delay <<
+                   unsigned (sf) << duration << frequencyMHz <<
+                   interferenceOnly);
+
+  // Skip receivers this transmission cannot have any effect on
+  if (IsCulled (m_phyList[j], rxPowerDbm))
+    {
+      NS_LOG_DEBUG ("Receiver culled, rxPower=" << rxPowerDbm << "dbm");
+      return;
+    }
+
+  if (m_batchedDelivery)
+    {
+      // Delivered later by ScheduleBatches
+      BatchEntry entry;
+      entry.receiver = j;
+      entry.rxPowerDbm = rxPowerDbm;
+      entry.delay = delay;
+      entry.interferenceOnly = interferenceOnly;
+      m_pending.push_back (entry);
+      return;
     }
+
+  // Get the id of the destination PHY to correctly format the context
+  Ptr<NetDevice> dstNetDevice = m_phyList[j]->GetDevice ();
+  uint32_t dstNode = 0;
+  if (dstNetDevice != 0)
+    {
+      NS_LOG_INFO ("Getting node index from NetDevice, since it exists");
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+      NS_LOG_DEBUG ("dstNode = " << dstNode);
+    }
+  else
+    {
+      NS_LOG_INFO ("No net device connected to the PHY, using context 0");
+    }
+
+  // Create the parameters object based on the calculations above
+  LoraChannelParameters parameters;
+  parameters.rxPowerDbm = rxPowerDbm;
+  parameters.sf = sf;
+  parameters.duration = duration;
+  parameters.frequencyMHz = frequencyMHz;
+
+  // Schedule the receive event
+  if (interferenceOnly)
+    {
+      NS_LOG_INFO ("Scheduling arrival of the packet as interference");
+      Simulator::ScheduleWithContext (dstNode, delay,
+                                      &LoraChannel::ReceiveInterference, this,
+                                      j, packet, parameters);
+    }
+  else
+    {
+      NS_LOG_INFO ("Scheduling reception of the packet");
+      Simulator::ScheduleWithContext (dstNode, delay, &LoraChannel::Receive,
+                                      this, j, packet, parameters);
+    }
+
+  // Fire the trace source for sent packet
+  m_packetSent (packet);
 }
 
 void
@@ -191,6 +470,440 @@ LoraChannel::Receive (uint32_t i, Ptr<Packet> packet,
                               parameters.duration, parameters.frequencyMHz);
 }
 
+void
+LoraChannel::ReceiveInterference (uint32_t i, Ptr<Packet> packet,
+                                  LoraChannelParameters parameters) const
+{
+  NS_LOG_FUNCTION (this << i << packet << parameters);
+
+  m_phyList[i]->ReceiveInterference (packet, parameters.rxPowerDbm,
+                                     parameters.sf, parameters.duration,
+                                     parameters.frequencyMHz);
+}
+
+bool
+LoraChannel::IsInterferenceOnly (Ptr<LoraPhy> sender,
+                                 Ptr<LoraPhy> receiver,
+                                 const LoraDeviceAddress *destination) const
+{
+  if (m_roleAwareDelivery && sender->IsGateway () == receiver->IsGateway ())
+    {
+      return true;
+    }
+  return destination != 0 && !receiver->AcceptsAddress (*destination);
+}
+
+bool
+LoraChannel::GetDestination (Ptr<LoraPhy> sender, Ptr<Packet> packet,
+                             LoraDeviceAddress &destination) const
+{
+  if (!m_addressFiltering || !sender->IsGateway ())
+    {
+      return false;
+    }
+
+  // The gateway MAC sets the destination of its downlinks in their LoraTag
+  LoraTag tag;
+  if (!packet->PeekPacketTag (tag) || !tag.HasDestination ())
+    {
+      return false;
+    }
+  destination = tag.GetDestination ();
+
+  NS_LOG_DEBUG ("Downlink for " << destination);
+
+  return true;
+}
+
+void
+LoraChannel::ScheduleBatches (Ptr<Packet> packet,
+                              LoraChannelParameters parameters) const
+{
+  NS_LOG_FUNCTION (this << packet << parameters);
+
+  // Group receivers by delay bucket, keeping them in list order inside each
+  // bucket
+  std::stable_sort (m_pending.begin (), m_pending.end (),
+                    [this] (const BatchEntry &a, const BatchEntry &b)
+                    { return GetDelayBucket (a.delay) < GetDelayBucket (b.delay); });
+
+  auto first = m_pending.begin ();
+  while (first != m_pending.end ())
+    {
+      int64_t bucket = GetDelayBucket (first->delay);
+      Time delay = first->delay;
+      auto last = first;
+      while (last != m_pending.end () && GetDelayBucket (last->delay) == bucket)
+        {
+          delay = std::min (delay, last->delay);
+          last++;
+        }
+
+      NS_LOG_INFO ("Scheduling reception of the packet at " <<
+                   std::distance (first, last) << " PHYs after " << delay);
+      Simulator::Schedule (delay, &LoraChannel::ReceiveBatch, this,
+                           std::vector<BatchEntry> (first, last), packet,
+                           parameters);
+      first = last;
+    }
+
+  m_pending.clear ();
+}
+
+int64_t
+LoraChannel::GetDelayBucket (Time delay) const
+{
+  if (m_delayResolution.IsStrictlyPositive ())
+    {
+      return delay.GetTimeStep () / m_delayResolution.GetTimeStep ();
+    }
+  return delay.GetTimeStep ();
+}
+
+void
+LoraChannel::ReceiveBatch (std::vector<BatchEntry> batch, Ptr<Packet> packet,
+                           LoraChannelParameters parameters) const
+{
+  NS_LOG_FUNCTION (this << batch.size () << packet << parameters);
+
+  for (const BatchEntry &entry : batch)
+    {
+      if (entry.interferenceOnly)
+        {
+          m_phyList[entry.receiver]->ReceiveInterference (packet,
+                                                          entry.rxPowerDbm,
+                                                          parameters.sf,
+                                                          parameters.duration,
+                                                          parameters.frequencyMHz);
+          continue;
+        }
+
+      m_phyList[entry.receiver]->StartReceive (packet, entry.rxPowerDbm,
+                                               parameters.sf,
+                                               parameters.duration,
+                                               parameters.frequencyMHz);
+    }
+}
+
+void
+LoraChannel::GatherCandidates (const Vector &position) const
+{
+  NS_LOG_FUNCTION (this << position);
+
+  m_candidates.clear ();
+
+  // Without a range limit, every PHY is a candidate
+  if (m_maxRange <= 0)
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          m_candidates.push_back (j);
+        }
+      return;
+    }
+
+  NS_ASSERT (!m_indexDirty);
+
+  // Cells are as wide as the range, so the disc around the sender is covered
+  // by its cell and the eight surrounding ones
+  int64_t cellX = std::floor (position.x / m_maxRange);
+  int64_t cellY = std::floor (position.y / m_maxRange);
+  for (int64_t x = cellX - 1; x <= cellX + 1; x++)
+    {
+      for (int64_t y = cellY - 1; y <= cellY + 1; y++)
+        {
+          auto cell = m_grid.find (GetCellKey (x, y));
+          if (cell != m_grid.end ())
+            {
+              m_candidates.insert (m_candidates.end (), cell->second.begin (),
+                                   cell->second.end ());
+            }
+        }
+    }
+
+  // Visit PHYs in the same order as the full list, so that reception events
+  // happening at the same time are scheduled in the same order
+  std::sort (m_candidates.begin (), m_candidates.end ());
+}
+
+uint64_t
+LoraChannel::GetCellKey (int64_t x, int64_t y)
+{
+  return (static_cast<uint64_t> (x) << 32) ^ static_cast<uint32_t> (y);
+}
+
+uint64_t
+LoraChannel::GetCellKey (const Vector &position) const
+{
+  return GetCellKey (std::floor (position.x / m_maxRange),
+                     std::floor (position.y / m_maxRange));
+}
+
+void
+LoraChannel::RebuildIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  DisconnectMobility ();
+  m_grid.clear ();
+  m_phyCell.assign (m_phyList.size (), 0);
+  m_phyIndex.clear ();
+  InvalidateLinkBudgets ();
+
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      m_phyIndex[m_phyList[j]] = j;
+
+      Ptr<MobilityModel> mobility = m_phyList[j]->GetMobility ();
+
+      // Listen for position changes the first time we see a mobility model
+      if (m_indexedMobility.find (mobility) == m_indexedMobility.end ())
+        {
+          mobility->TraceConnectWithoutContext
+            ("CourseChange", MakeCallback (&LoraChannel::NotifyCourseChange, this));
+        }
+      m_indexedMobility[mobility].push_back (j);
+
+      if (m_maxRange > 0)
+        {
+          m_phyCell[j] = GetCellKey (mobility->GetPosition ());
+          m_grid[m_phyCell[j]].push_back (j);
+        }
+    }
+
+  m_indexDirty = false;
+}
+
+void
+LoraChannel::DisconnectMobility (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (auto &indexed : m_indexedMobility)
+    {
+      indexed.first->TraceDisconnectWithoutContext
+        ("CourseChange", MakeCallback (&LoraChannel::NotifyCourseChange, this));
+    }
+  m_indexedMobility.clear ();
+}
+
+void
+LoraChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+
+  // A full rebuild will take care of this
+  if (m_indexDirty)
+    {
+      return;
+    }
+
+  auto indexed = m_indexedMobility.find (ConstCast<MobilityModel> (mobility));
+  if (indexed == m_indexedMobility.end ())
+    {
+      return;
+    }
+
+  // Links from and to the moved PHYs changed
+  if (IsLinkBudgetStored ())
+    {
+      for (uint32_t j : indexed->second)
+        {
+          UpdateLinkBudgets (j);
+        }
+    }
+
+  if (m_maxRange <= 0)
+    {
+      return;
+    }
+
+  uint64_t newCell = GetCellKey (mobility->GetPosition ());
+  for (uint32_t j : indexed->second)
+    {
+      if (m_phyCell[j] == newCell)
+        {
+          continue;
+        }
+
+      // Move the PHY to its new cell
+      std::vector<uint32_t> &oldCell = m_grid[m_phyCell[j]];
+      oldCell.erase (std::find (oldCell.begin (), oldCell.end (), j));
+      if (oldCell.empty ())
+        {
+          m_grid.erase (m_phyCell[j]);
+        }
+      m_phyCell[j] = newCell;
+      m_grid[newCell].push_back (j);
+    }
+}
+
+const std::vector<LoraChannel::LinkBudget> &
+LoraChannel::GetLinkBudgets (Ptr<LoraPhy> sender) const
+{
+  NS_LOG_FUNCTION (this << sender);
+
+  NS_ASSERT (!m_indexDirty);
+
+  auto index = m_phyIndex.find (sender);
+  NS_ASSERT_MSG (index != m_phyIndex.end (),
+                 "Sender PHY is not connected to the channel");
+  uint32_t i = index->second;
+
+  if (m_linkBudgetsValid[i])
+    {
+      return m_linkBudgets[i];
+    }
+
+  NS_LOG_DEBUG ("Computing link budgets for PHY " << i);
+
+  std::vector<LinkBudget> &links = m_linkBudgets[i];
+  links.clear ();
+
+  GatherCandidates (sender->GetMobility ()->GetPosition ());
+  for (uint32_t j : m_candidates)
+    {
+      LinkBudget link;
+      if (j != i && ComputeLinkBudget (i, j, link))
+        {
+          links.push_back (link);
+        }
+    }
+  links.shrink_to_fit ();
+
+  m_linkBudgetsValid[i] = true;
+  return links;
+}
+
+bool
+LoraChannel::ComputeLinkBudget (uint32_t i, uint32_t j, LinkBudget &link) const
+{
+  Ptr<MobilityModel> senderMobility = m_phyList[i]->GetMobility ();
+  Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ();
+
+  if (m_maxRange > 0 &&
+      senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+    {
+      return false;
+    }
+
+  double gainDb = GetRxPower (0, senderMobility, receiverMobility);
+  if (m_maxPathLossDb > 0 && -gainDb > m_maxPathLossDb)
+    {
+      return false;
+    }
+
+  link.receiver = j;
+  link.gainDb = gainDb;
+  link.delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  return true;
+}
+
+void
+LoraChannel::UpdateLinkBudgets (uint32_t j) const
+{
+  NS_LOG_FUNCTION (this << j);
+
+  // The links from the moved PHY are computed again when they are needed
+  m_linkBudgetsValid[j] = false;
+  m_linkBudgets[j].clear ();
+
+  // Links towards the moved PHY are updated in the other stored rows, since
+  // the PHY may also have entered or left their range
+  for (uint32_t i = 0; i < m_linkBudgets.size (); i++)
+    {
+      if (i == j || !m_linkBudgetsValid[i])
+        {
+          continue;
+        }
+
+      std::vector<LinkBudget> &links = m_linkBudgets[i];
+      auto stored = std::lower_bound (links.begin (), links.end (), j,
+                                      [] (const LinkBudget &l, uint32_t r)
+                                      { return l.receiver < r; });
+      bool found = stored != links.end () && stored->receiver == j;
+
+      LinkBudget link;
+      if (ComputeLinkBudget (i, j, link))
+        {
+          if (found)
+            {
+              *stored = link;
+            }
+          else
+            {
+              links.insert (stored, link);
+            }
+        }
+      else if (found)
+        {
+          links.erase (stored);
+        }
+    }
+}
+
+void
+LoraChannel::InvalidateLinkBudgets (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  m_linkBudgets.resize (m_phyList.size ());
+  m_linkBudgetsValid.assign (m_phyList.size (), false);
+}
+
+void
+LoraChannel::SetMaxRange (double maxRange)
+{
+  m_maxRange = maxRange;
+  m_indexDirty = true;
+}
+
+double
+LoraChannel::GetMaxRange (void) const
+{
+  return m_maxRange;
+}
+
+void
+LoraChannel::SetStaticTopology (bool staticTopology)
+{
+  m_staticTopology = staticTopology;
+  m_indexDirty = true;
+}
+
+bool
+LoraChannel::GetStaticTopology (void) const
+{
+  return m_staticTopology;
+}
+
+void
+LoraChannel::SetMaxPathLoss (double maxPathLossDb)
+{
+  m_maxPathLossDb = maxPathLossDb;
+  m_indexDirty = true;
+}
+
+double
+LoraChannel::GetMaxPathLoss (void) const
+{
+  return m_maxPathLossDb;
+}
+
+bool
+LoraChannel::IsCulled (Ptr<LoraPhy> receiver, double rxPowerDbm) const
+{
+  // Under the ALOHA collision matrix any overlap on the same SF destroys a
+  // packet, regardless of its power: no transmission can be safely ignored.
+  if (!m_receiverCulling ||
+      LoraInterferenceHelper::collisionMatrix == LoraInterferenceHelper::ALOHA)
+    {
+      return false;
+    }
+
+  return rxPowerDbm < receiver->GetMinSensitivity () - m_interferenceMarginDb;
+}
+
 double
 LoraChannel::GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
                          Ptr<MobilityModel> receiverMobility) const
@@ -198,6 +911,256 @@ LoraChannel::GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
   return m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
 }
 
+double
+LoraChannel::GetRxPower (double txPowerDbm, Ptr<LoraPhy> sender,
+                         Ptr<LoraPhy> receiver) const
+{
+  NS_LOG_FUNCTION (this << txPowerDbm << sender << receiver);
+
+  const LinkBudget *link = FindLinkBudget (sender, receiver);
+  if (link != 0)
+    {
+      return txPowerDbm + link->gainDb;
+    }
+
+  // Fall back to the loss model for links that are not stored
+  return GetRxPower (txPowerDbm, sender->GetMobility (), receiver->GetMobility ());
+}
+
+const LoraChannel::LinkBudget *
+LoraChannel::FindLinkBudget (Ptr<LoraPhy> sender, Ptr<LoraPhy> receiver) const
+{
+  if (!IsLinkBudgetStored ())
+    {
+      return 0;
+    }
+
+  if (m_indexDirty)
+    {
+      RebuildIndex ();
+    }
+
+  auto receiverIndex = m_phyIndex.find (receiver);
+  if (receiverIndex == m_phyIndex.end ()
+      || m_phyIndex.find (sender) == m_phyIndex.end ())
+    {
+      return 0;
+    }
+
+  // Links are sorted by receiver index
+  const std::vector<LinkBudget> &links = GetLinkBudgets (sender);
+  uint32_t j = receiverIndex->second;
+  auto link = std::lower_bound (links.begin (), links.end (), j,
+                                [] (const LinkBudget &l, uint32_t r)
+                                { return l.receiver < r; });
+  if (link != links.end () && link->receiver == j)
+    {
+      return &(*link);
+    }
+  return 0;
+}
+
+bool
+LoraChannel::IsInterferenceShared (void) const
+{
+  return m_sharedInterference || m_lazyReception;
+}
+
+bool
+LoraChannel::IsLinkBudgetStored (void) const
+{
+  // Interference from the shared record is evaluated with stored links, so
+  // that the loss model is not called for each transmission at each reception
+  return m_staticTopology || IsInterferenceShared ();
+}
+
+void
+LoraChannel::GetInterferenceEnergy (Ptr<LoraPhy> receiver,
+                                    Ptr<LoraInterferenceHelper::Event> event,
+                                    std::vector<double> &energy) const
+{
+  NS_LOG_FUNCTION (this << receiver << event);
+
+  NS_ASSERT (energy.size () == 6);
+
+  Time eventStart = event->GetStartTime ();
+  Time eventEnd = event->GetEndTime ();
+
+  // Only transmissions on the same channel can interfere
+  auto transmissions = m_ledger.find (event->GetFrequency ());
+  if (transmissions == m_ledger.end ())
+    {
+      return;
+    }
+  const std::deque<Transmission> &ledger = transmissions->second;
+
+  NS_LOG_INFO ("Current number of transmissions in the ledger: " << ledger.size ());
+
+  // Skip the transmissions that ended too early to reach the receiver during
+  // the event
+  auto first = std::lower_bound (ledger.begin (), ledger.end (),
+                                 eventStart - GetLedgerHorizon (),
+                                 [] (const Transmission &t, Time start)
+                                 { return t.startTime < start; });
+
+  // Find the transmission the event belongs to: the one carrying the same
+  // packet that reached the receiver closest to the start of the event. The
+  // same packet object may be sent by several PHYs.
+  const Transmission *own = 0;
+  Time ownMismatch = Time::Max ();
+  for (auto it = first; it != ledger.end (); ++it)
+    {
+      const Transmission &transmission = *it;
+      if (transmission.startTime > eventStart)
+        {
+          break;
+        }
+      double gainDb;
+      Time delay;
+      if (transmission.packet != event->GetPacket ()
+          || transmission.sender == receiver
+          || !GetLink (transmission.sender, receiver, gainDb, delay))
+        {
+          continue;
+        }
+      Time mismatch = Abs (transmission.startTime + delay - eventStart);
+      if (mismatch < ownMismatch)
+        {
+          own = &transmission;
+          ownMismatch = mismatch;
+        }
+    }
+
+  for (auto it = first; it != ledger.end (); ++it)
+    {
+      const Transmission &transmission = *it;
+
+      // Transmissions are sorted by start time, and propagation can only
+      // delay them further
+      if (transmission.startTime >= eventEnd)
+        {
+          break;
+        }
+
+      // Skip the event itself and the receiver's own transmissions, that
+      // were never delivered to it
+      if (&transmission == own || transmission.sender == receiver)
+        {
+          continue;
+        }
+
+      // Use the same link budget this transmission was delivered with
+      double gainDb;
+      Time delay;
+      if (!GetLink (transmission.sender, receiver, gainDb, delay))
+        {
+          continue;
+        }
+      double rxPowerDbm = transmission.txPowerDbm + gainDb;
+      if (IsCulled (receiver, rxPowerDbm))
+        {
+          continue;
+        }
+
+      Time overlap = std::min (transmission.endTime + delay, eventEnd) -
+        std::max (transmission.startTime + delay, eventStart);
+      if (!overlap.IsStrictlyPositive ())
+        {
+          continue;
+        }
+
+      // Apply the receiver's floor, as if the signal had not been stored
+      if (receiver->DropsInterference (rxPowerDbm))
+        {
+          continue;
+        }
+
+      NS_LOG_DEBUG ("Interferer: sf = " << unsigned (transmission.sf) <<
+                    ", power = " << rxPowerDbm << ", overlap = " <<
+                    overlap.GetSeconds () << " s");
+
+      // Energy [J] = Time [s] * Power [W]
+      double interfererPowerW = pow (10, rxPowerDbm / 10) / 1000;
+      energy[unsigned (transmission.sf) - 7] += overlap.GetSeconds () * interfererPowerW;
+    }
+}
+
+bool
+LoraChannel::GetLink (Ptr<LoraPhy> sender, Ptr<LoraPhy> receiver,
+                      double &gainDb, Time &delay) const
+{
+  if (IsLinkBudgetStored ())
+    {
+      const LinkBudget *link = FindLinkBudget (sender, receiver);
+      if (link != 0)
+        {
+          gainDb = link->gainDb;
+          delay = link->delay;
+          return true;
+        }
+
+      // Links between connected PHYs were not stored because they were
+      // out of range or above the path loss cutoff
+      if (m_phyIndex.find (sender) != m_phyIndex.end ()
+          && m_phyIndex.find (receiver) != m_phyIndex.end ())
+        {
+          return false;
+        }
+    }
+
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ();
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  if (m_maxRange > 0 &&
+      senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+    {
+      return false;
+    }
+
+  gainDb = GetRxPower (0, senderMobility, receiverMobility);
+  delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  return true;
+}
+
+void
+LoraChannel::RecordTransmission (Ptr<LoraPhy> sender, Ptr<Packet> packet,
+                                 double txPowerDbm, uint8_t sf, Time duration,
+                                 double frequencyMHz) const
+{
+  NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << unsigned (sf) <<
+                   duration << frequencyMHz);
+
+  Time now = Simulator::Now ();
+
+  Transmission transmission;
+  transmission.sender = sender;
+  transmission.packet = packet;
+  transmission.startTime = now;
+  transmission.endTime = now + duration;
+  transmission.txPowerDbm = txPowerDbm;
+  transmission.sf = sf;
+  m_ledger[frequencyMHz].push_back (transmission);
+
+  m_maxLedgerDuration = std::max (m_maxLedgerDuration, duration);
+
+  // Drop transmissions that can no longer overlap with a reception that has
+  // yet to end
+  for (auto &transmissions : m_ledger)
+    {
+      std::deque<Transmission> &ledger = transmissions.second;
+      while (!ledger.empty () && ledger.front ().endTime + GetLedgerHorizon () < now)
+        {
+          ledger.pop_front ();
+        }
+    }
+}
+
+Time
+LoraChannel::GetLedgerHorizon (void) const
+{
+  // The extra second largely accounts for propagation delays
+  return m_maxLedgerDuration + Seconds (1);
+}
+
 std::ostream &operator << (std::ostream &os, const LoraChannelParameters &params)
 {
   os << "(rxPowerDbm: " << params.rxPowerDbm << ", SF: " << unsigned(params.sf) <<
@@ -25,7 +25,12 @@
 #define LORA_CHANNEL_H
 
 #include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include "ns3/lora-interference-helper.h"
 #include "ns3/lora-phy.h"
+#include "ns3/lora-device-address.h"
 #include "ns3/mobility-model.h"
 #include "ns3/channel.h"
 #include "ns3/net-device.h"
@@ -153,7 +158,255 @@ public:
   double GetRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility,
                      Ptr<MobilityModel> receiverMobility) const;
 
+  /**
+    * Compute the received power of a transmission between two PHYs.
+    *
+    * If the StaticTopology attribute is enabled and both PHYs are connected
+    * to this channel, the stored link budget is used. Otherwise, this is
+    * equivalent to calling GetRxPower with the PHYs' mobility models.
+    *
+    * \param txPowerDbm The power the transmitter is using, in dBm.
+    * \param sender The transmitting PHY.
+    * \param receiver The receiving PHY.
+    * \return The received power in dBm.
+    */
+  double GetRxPower (double txPowerDbm, Ptr<LoraPhy> sender,
+                     Ptr<LoraPhy> receiver) const;
+
+  /**
+    * Check whether a transmission arriving at a PHY can be safely ignored.
+    *
+    * When receiver culling is enabled, a transmission is culled if its power
+    * at the receiver is below the receiver's best-case sensitivity minus the
+    * interference margin: such a signal can neither be locked on nor push the
+    * SNIR of a receivable packet below the isolation thresholds.
+    *
+    * \param receiver The PHY the transmission is arriving at.
+    * \param rxPowerDbm The power of the transmission at the receiver.
+    * \return true if the receiver need not be notified of the transmission.
+    */
+  bool IsCulled (Ptr<LoraPhy> receiver, double rxPowerDbm) const;
+
+  /**
+    * Whether this channel keeps a shared record of transmissions that PHYs
+    * should use to evaluate interference.
+    *
+    * \return true if either the SharedInterference or the LazyReception
+    * attribute is set.
+    */
+  bool IsInterferenceShared (void) const;
+
+  /**
+    * Compute the interference energy a PHY was subject to during an event,
+    * using the shared record of transmissions.
+    *
+    * \param receiver The PHY that received the event.
+    * \param event The event, as it was seen by the receiver.
+    * \param energy The energy [J] of the interference for each SF from 7 to
+    * 12, to which the contributions of the overlapping transmissions are
+    * added.
+    */
+  void GetInterferenceEnergy (Ptr<LoraPhy> receiver,
+                              Ptr<LoraInterferenceHelper::Event> event,
+                              std::vector<double> &energy) const;
+
 private:
+  /**
+    * The path gain and propagation delay from a PHY to a receiver.
+    */
+  struct LinkBudget
+  {
+    uint32_t receiver; //!< The index of the receiver in m_phyList
+    float gainDb;      //!< The received power of a 0 dBm transmission
+    Time delay;        //!< The propagation delay
+  };
+
+  /**
+    * A transmission in the shared record.
+    */
+  struct Transmission
+  {
+    Ptr<LoraPhy> sender;  //!< The transmitting PHY
+    Ptr<Packet> packet;   //!< The transmitted packet
+    Time startTime;       //!< The start of the transmission, at the sender
+    Time endTime;         //!< The end of the transmission, at the sender
+    double txPowerDbm;    //!< The transmission power
+    uint8_t sf;           //!< The spreading factor of the transmission
+  };
+
+  /**
+    * Add a transmission to the shared record, and drop the transmissions that
+    * can no longer interfere with any reception.
+    *
+    * \param sender The transmitting PHY.
+    * \param packet The transmitted packet.
+    * \param txPowerDbm The transmission power.
+    * \param sf The spreading factor of the transmission.
+    * \param duration The on-air duration of the transmission.
+    * \param frequencyMHz The frequency of the transmission.
+    */
+  void RecordTransmission (Ptr<LoraPhy> sender, Ptr<Packet> packet,
+                           double txPowerDbm, uint8_t sf, Time duration,
+                           double frequencyMHz) const;
+
+  /**
+    * Get how long a transmission is kept in the shared record after its
+    * start: the longest transmission so far, plus a margin for propagation
+    * delays.
+    */
+  Time GetLedgerHorizon (void) const;
+
+  /**
+    * Whether link budgets are stored and reused, either because the topology
+    * is static or because interference is evaluated on the shared record.
+    */
+  bool IsLinkBudgetStored (void) const;
+
+  /**
+    * Get the path gain and propagation delay between two PHYs, applying the
+    * same range and path loss limits used when delivering transmissions.
+    *
+    * \param sender The transmitting PHY.
+    * \param receiver The receiving PHY.
+    * \param gainDb Set to the received power of a 0 dBm transmission.
+    * \param delay Set to the propagation delay.
+    * \return false if the receiver is never notified of the sender's
+    * transmissions.
+    */
+  bool GetLink (Ptr<LoraPhy> sender, Ptr<LoraPhy> receiver, double &gainDb,
+                Time &delay) const;
+
+  /**
+    * Find the stored link budget from a PHY to another one.
+    *
+    * \param sender The transmitting PHY.
+    * \param receiver The receiving PHY.
+    * \return The link budget, or 0 if link budgets are not stored, one of
+    * the PHYs is not connected or the link was not stored.
+    */
+  const LinkBudget *FindLinkBudget (Ptr<LoraPhy> sender,
+                                    Ptr<LoraPhy> receiver) const;
+
+  /**
+    * A receiver of a batched transmission.
+    */
+  struct BatchEntry
+  {
+    uint32_t receiver; //!< The index of the receiver in m_phyList
+    double rxPowerDbm; //!< The power of the transmission at the receiver
+    Time delay;        //!< The propagation delay
+    bool interferenceOnly; //!< Whether the receiver only registers interference
+  };
+
+  /**
+    * Compute the link budget from a sender to a PHY using the propagation
+    * models and schedule the reception.
+    *
+    * \param j The index of the receiving PHY.
+    * \param senderMobility The mobility model of the sender.
+    * \param packet The packet being transmitted.
+    * \param txPowerDbm The power of the transmission.
+    * \param sf The spreading factor of the transmission.
+    * \param duration The on-air duration of the transmission.
+    * \param frequencyMHz The frequency of the transmission.
+    * \param interferenceOnly Whether the PHY only registers the transmission
+    * as interference.
+    */
+  void ComputeAndScheduleReception (uint32_t j,
+                                    Ptr<MobilityModel> senderMobility,
+                                    Ptr<Packet> packet, double txPowerDbm,
+                                    uint8_t sf, Time duration,
+                                    double frequencyMHz,
+                                    bool interferenceOnly) const;
+
+  /**
+    * Notify a PHY of a transmission after the propagation delay, unless the
+    * transmission can be culled at that PHY.
+    *
+    * With batched delivery, the reception is only queued in m_pending.
+    *
+    * \param j The index of the receiving PHY.
+    * \param packet The packet being transmitted.
+    * \param rxPowerDbm The power of the transmission at the receiver.
+    * \param delay The propagation delay.
+    * \param sf The spreading factor of the transmission.
+    * \param duration The on-air duration of the transmission.
+    * \param frequencyMHz The frequency of the transmission.
+    * \param interferenceOnly Whether the PHY only registers the transmission
+    * as interference.
+    */
+  void ScheduleReception (uint32_t j, Ptr<Packet> packet, double rxPowerDbm,
+                          Time delay, uint8_t sf, Time duration,
+                          double frequencyMHz, bool interferenceOnly) const;
+
+  /**
+    * Whether a PHY only needs to register a transmission as interference,
+    * because it has the same role as the sender, or because it filters out
+    * the destination of the transmission.
+    *
+    * \param sender The transmitting PHY.
+    * \param receiver The receiving PHY.
+    * \param destination The destination of the transmission, or 0 if it is
+    * not known.
+    * \return true if RoleAwareDelivery is enabled and both PHYs are gateways,
+    * or both are end devices, or if the receiver does not accept the
+    * destination.
+    */
+  bool IsInterferenceOnly (Ptr<LoraPhy> sender, Ptr<LoraPhy> receiver,
+                           const LoraDeviceAddress *destination) const;
+
+  /**
+    * Read the destination address of a downlink from its LoraTag.
+    *
+    * \param sender The transmitting PHY.
+    * \param packet The transmitted packet.
+    * \param destination The address to fill in.
+    * \return true if AddressFiltering is enabled and the sender set the
+    * destination of the packet, false otherwise.
+    */
+  bool GetDestination (Ptr<LoraPhy> sender, Ptr<Packet> packet,
+                       LoraDeviceAddress &destination) const;
+
+  /**
+    * Get the link budgets from a PHY towards the PHYs it can reach, sorted by
+    * receiver index, computing them if they are not available.
+    *
+    * \param sender The transmitting PHY.
+    * \return The link budgets of the sender.
+    */
+  const std::vector<LinkBudget> &GetLinkBudgets (Ptr<LoraPhy> sender) const;
+
+  /**
+    * Compute the link budget from a PHY to another one, applying the range
+    * and path loss limits.
+    *
+    * \param i The index of the transmitting PHY in m_phyList.
+    * \param j The index of the receiving PHY in m_phyList.
+    * \param link Set to the link budget.
+    * \return false if the link is not stored.
+    */
+  bool ComputeLinkBudget (uint32_t i, uint32_t j, LinkBudget &link) const;
+
+  /**
+    * Discard the stored link budgets from a PHY that moved, and update the
+    * links towards it in the rows of the other PHYs.
+    *
+    * \param j The index of the PHY in m_phyList.
+    */
+  void UpdateLinkBudgets (uint32_t j) const;
+
+  /**
+    * Discard all stored link budgets.
+    */
+  void InvalidateLinkBudgets (void) const;
+
+  void SetMaxRange (double maxRange);
+  double GetMaxRange (void) const;
+  void SetStaticTopology (bool staticTopology);
+  bool GetStaticTopology (void) const;
+  void SetMaxPathLoss (double maxPathLossDb);
+  double GetMaxPathLoss (void) const;
+
   /**
     * Private method that is scheduled by LoraChannel's Send method to happen
     * after the channel delay, for each of the connected PHY layers.
@@ -168,6 +421,90 @@ private:
   void Receive (uint32_t i, Ptr<Packet> packet,
                 LoraChannelParameters parameters) const;
 
+  /**
+    * Let a PHY register a transmission as interference, without trying to
+    * receive it.
+    *
+    * \param i The index of the phy.
+    * \param packet The transmitted packet.
+    * \param parameters The parameters that characterize this transmission
+    */
+  void ReceiveInterference (uint32_t i, Ptr<Packet> packet,
+                            LoraChannelParameters parameters) const;
+
+  /**
+    * Schedule one ReceiveBatch event for each delay bucket of the receivers
+    * queued in m_pending, and clear it.
+    *
+    * \param packet The packet being transmitted.
+    * \param parameters The parameters of the transmission. The receive power
+    * is taken from each entry.
+    */
+  void ScheduleBatches (Ptr<Packet> packet,
+                        LoraChannelParameters parameters) const;
+
+  /**
+    * Get the delay bucket a propagation delay falls into.
+    *
+    * \param delay The propagation delay.
+    * \return The index of the bucket.
+    */
+  int64_t GetDelayBucket (Time delay) const;
+
+  /**
+    * Start the reception of a packet at a group of PHYs.
+    *
+    * \param batch The PHYs to start reception on.
+    * \param packet The packet the PHYs will receive.
+    * \param parameters The parameters that characterize this transmission.
+    */
+  void ReceiveBatch (std::vector<BatchEntry> batch, Ptr<Packet> packet,
+                     LoraChannelParameters parameters) const;
+
+  /**
+    * Fill m_candidates with the indices of the PHYs that can be reached by a
+    * transmission, in increasing order.
+    *
+    * If no range limit is set this is the whole m_phyList, otherwise only PHYs
+    * in the grid cells surrounding the transmitter are considered.
+    *
+    * \param position The position of the transmitter.
+    */
+  void GatherCandidates (const Vector &position) const;
+
+  /**
+    * Build the grid index of PHY positions and the index of PHYs from scratch,
+    * and start listening for position changes.
+    */
+  void RebuildIndex (void) const;
+
+  /**
+    * Stop listening for position changes of the indexed PHYs.
+    */
+  void DisconnectMobility (void) const;
+
+  /**
+    * Move the PHYs using a mobility model to their new cell after the model
+    * fired its CourseChange trace source.
+    *
+    * \param mobility The mobility model whose position changed.
+    */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility) const;
+
+  /**
+    * Get the key of a grid cell from its coordinates.
+    *
+    * The coordinates are packed as unsigned values, so that cells with
+    * negative coordinates map to distinct keys without shifting a negative
+    * number.
+    */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+
+  /**
+    * Get the key of the grid cell containing a position.
+    */
+  uint64_t GetCellKey (const Vector &position) const;
+
   /**
     * The vector containing the PHYs that are currently connected to the
     * channel.
@@ -187,6 +524,125 @@ private:
     */
   Ptr<PropagationDelayModel> m_delay;
 
+  /**
+   * Whether to skip receivers that cannot be affected by a transmission.
+   */
+  bool m_receiverCulling;
+
+  /**
+   * The margin [dB] below a receiver's best sensitivity under which a
+   * transmission is considered negligible, also as interference.
+   */
+  double m_interferenceMarginDb;
+
+  /**
+   * The distance [m] beyond which PHYs are not notified of transmissions, and
+   * the size of the cells of the spatial index. Zero disables both.
+   */
+  double m_maxRange;
+
+  /**
+   * The spatial index, mapping the key of each grid cell to the indices of the
+   * PHYs it contains.
+   */
+  mutable std::unordered_map<uint64_t, std::vector<uint32_t> > m_grid;
+
+  /**
+   * Whether path loss and delay between PHYs are computed once and reused.
+   */
+  bool m_staticTopology;
+
+  /**
+   * The path loss [dB] above which links are not stored. Zero disables the
+   * cutoff.
+   */
+  double m_maxPathLossDb;
+
+  /**
+   * The link budgets from each PHY, indexed like m_phyList.
+   */
+  mutable std::vector<std::vector<LinkBudget> > m_linkBudgets;
+
+  /**
+   * Whether the entries of m_linkBudgets are up to date.
+   */
+  mutable std::vector<bool> m_linkBudgetsValid;
+
+  /**
+   * The index of each PHY in m_phyList.
+   */
+  mutable std::map<Ptr<LoraPhy>, uint32_t> m_phyIndex;
+
+  /**
+   * The key of the cell each PHY is currently indexed in.
+   */
+  mutable std::vector<uint64_t> m_phyCell;
+
+  /**
+   * The mobility models we are listening to, with the indices of the PHYs
+   * that use them.
+   */
+  mutable std::map<Ptr<MobilityModel>, std::vector<uint32_t> > m_indexedMobility;
+
+  /**
+   * Whether receivers are notified with one event per delay bucket.
+   */
+  bool m_batchedDelivery;
+
+  /**
+   * The width of the delay buckets used by batched delivery.
+   */
+  Time m_delayResolution;
+
+  /**
+   * Receivers of the current transmission waiting to be batched.
+   */
+  mutable std::vector<BatchEntry> m_pending;
+
+  /**
+   * Whether PHYs evaluate interference using m_ledger.
+   */
+  bool m_sharedInterference;
+
+  /**
+   * Whether transmissions are only delivered to listening PHYs.
+   */
+  bool m_lazyReception;
+
+  /**
+   * Whether PHYs with the same role as the sender only register
+   * transmissions as interference.
+   */
+  bool m_roleAwareDelivery;
+
+  /**
+   * Whether downlinks are only delivered for reception to PHYs accepting
+   * their destination address.
+   */
+  bool m_addressFiltering;
+
+  /**
+   * The transmissions that can still interfere with a reception, grouped by
+   * frequency and sorted by start time.
+   */
+  mutable std::map<double, std::deque<Transmission> > m_ledger;
+
+  /**
+   * The longest transmission recorded in m_ledger so far.
+   */
+  mutable Time m_maxLedgerDuration;
+
+  /**
+   * Whether the set of PHYs changed since the index was last built.
+   */
+  mutable bool m_indexDirty;
+
+  /**
+   * Scratch vector holding the candidate receivers of the current
+   * transmission.
+   */
+  mutable std::vector<uint32_t> m_candidates;
+
   /**
    * Callback for when a packet is being sent on the channel.
    */
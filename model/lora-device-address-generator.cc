@@ -61,10 +61,16 @@ LoraDeviceAddressGenerator::NextAddress (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  NwkAddr oldNwkAddr = m_currentNwkAddr;
+  LoraDeviceAddress address (m_currentNwkId, m_currentNwkAddr);
   m_currentNwkAddr.Set (m_currentNwkAddr.Get () + 1);
 
-  return LoraDeviceAddress (m_currentNwkId, oldNwkAddr);
+  // The broadcast address is reserved
+  if (address.IsBroadcast ())
+    {
+      return NextAddress ();
+    }
+
+  return address;
 }
 
 LoraDeviceAddress
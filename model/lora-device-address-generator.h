@@ -63,7 +63,8 @@ public:
    * This operation is a post-increment, meaning that the first address
    * allocated will be the one that was initially configured.
    *
-   * This keeps the nwkId constant, only incrementing nwkAddr.
+   * This keeps the nwkId constant, only incrementing nwkAddr. The broadcast
+   * address, LoraDeviceAddress::GetBroadcast (), is skipped.
    *
    * \return the LoraDeviceAddress address
    */
@@ -171,6 +171,18 @@ LoraDeviceAddress::GetType (void)
   return type;
 }
 
+LoraDeviceAddress
+LoraDeviceAddress::GetBroadcast (void)
+{
+  return LoraDeviceAddress (0xFFFFFFFF);
+}
+
+bool
+LoraDeviceAddress::IsBroadcast (void) const
+{
+  return Get () == 0xFFFFFFFF;
+}
+
 uint32_t
 LoraDeviceAddress::Get (void) const
 {
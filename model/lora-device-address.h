@@ -186,6 +186,21 @@ public:
    */
   void SetNwkAddr (uint32_t nwkAddr);
 
+  /**
+   * Get the address that downlinks meant for all devices are sent to.
+   *
+   * This is the all-ones address, which LoraDeviceAddressGenerator never
+   * hands out.
+   *
+   * \return The broadcast address.
+   */
+  static LoraDeviceAddress GetBroadcast (void);
+
+  /**
+   * Whether this is the broadcast address.
+   */
+  bool IsBroadcast (void) const;
+
   /**
    * Print the address bit-by-bit to a human-readable string.
    *
@@ -98,11 +98,7 @@ LoraFrameHeader::Serialize (Buffer::Iterator start) const
   start.WriteU16 (m_fCnt);
 
   // FOpts field
-  for (auto it = m_macCommands.begin (); it != m_macCommands.end (); it++)
-    {
-      NS_LOG_DEBUG ("Serializing a MAC command");
-      (*it)->Serialize (start);
-    }
+  start.Write (m_fOpts.data (), m_fOptsLen);
 
   // FPort
   start.WriteU8 (m_fPort);
@@ -122,9 +118,6 @@ LoraFrameHeader::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  // Empty the list of MAC commands
-  m_macCommands.clear ();
-
   // Read from buffer and save into local variables
   m_address.Set (start.ReadU32 ());
   // TODO FCtrl has different meanings for UL and DL packets. Handle this
@@ -146,178 +139,8 @@ LoraFrameHeader::Deserialize (Buffer::Iterator start)
   NS_LOG_DEBUG ("fOptsLen: " << unsigned (m_fOptsLen));
   NS_LOG_DEBUG ("fCnt: " << unsigned (m_fCnt));
 
-  // Deserialize MAC commands
-  NS_LOG_DEBUG ("Starting deserialization of MAC commands");
-  for (uint8_t byteNumber = 0; byteNumber < m_fOptsLen;)
-    {
-      uint8_t cid = start.PeekU8 ();
-      NS_LOG_DEBUG ("CID: " << unsigned(cid));
-
-      // Divide Uplink and Downlink messages
-      // This needs to be done because they have the same CID, and the context
-      // about where this message will be Serialized/Deserialized (i.e., at the
-      // ED or at the NS) is umportant.
-      if (m_isUplink)
-        {
-          switch (cid)
-            {
-            // In the case of Uplink messages, the NS will deserialize the
-            // request for a link check
-            case (0x02):
-              {
-                NS_LOG_DEBUG ("Creating a LinkCheckReq command");
-                Ptr<LinkCheckReq> command = Create <LinkCheckReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x03):
-              {
-                NS_LOG_DEBUG ("Creating a LinkAdrAns command");
-                Ptr<LinkAdrAns> command = Create <LinkAdrAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x04):
-              {
-                NS_LOG_DEBUG ("Creating a DutyCycleAns command");
-                Ptr<DutyCycleAns> command = Create <DutyCycleAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x05):
-              {
-                NS_LOG_DEBUG ("Creating a RxParamSetupAns command");
-                Ptr<RxParamSetupAns> command = Create <RxParamSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x06):
-              {
-                NS_LOG_DEBUG ("Creating a DevStatusAns command");
-                Ptr<DevStatusAns> command = Create <DevStatusAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x07):
-              {
-                NS_LOG_DEBUG ("Creating a NewChannelAns command");
-                Ptr<NewChannelAns> command = Create <NewChannelAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x08):
-              {
-                NS_LOG_DEBUG ("Creating a RxTimingSetupAns command");
-                Ptr<RxTimingSetupAns> command = Create <RxTimingSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x09):
-              {
-                NS_LOG_DEBUG ("Creating a TxParamSetupAns command");
-                Ptr<TxParamSetupAns> command = Create <TxParamSetupAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x0A):
-              {
-                NS_LOG_DEBUG ("Creating a DlChannelAns command");
-                Ptr<DlChannelAns> command = Create <DlChannelAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            default:
-              {
-                NS_LOG_ERROR ("CID not recognized during deserialization");
-              }
-            }
-        }
-      else
-        {
-          switch (cid)
-            {
-            // In the case of Downlink messages, the ED will deserialize the
-            // answer to a link check
-            case (0x02):
-              {
-                NS_LOG_DEBUG ("Creating a LinkCheckAns command");
-                Ptr<LinkCheckAns> command = Create <LinkCheckAns> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x03):
-              {
-                NS_LOG_DEBUG ("Creating a LinkAdrReq command");
-                Ptr<LinkAdrReq> command = Create <LinkAdrReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x04):
-              {
-                NS_LOG_DEBUG ("Creating a DutyCycleReq command");
-                Ptr<DutyCycleReq> command = Create <DutyCycleReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x05):
-              {
-                NS_LOG_DEBUG ("Creating a RxParamSetupReq command");
-                Ptr<RxParamSetupReq> command = Create <RxParamSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x06):
-              {
-                NS_LOG_DEBUG ("Creating a DevStatusReq command");
-                Ptr<DevStatusReq> command = Create <DevStatusReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x07):
-              {
-                NS_LOG_DEBUG ("Creating a NewChannelReq command");
-                Ptr<NewChannelReq> command = Create <NewChannelReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x08):
-              {
-                NS_LOG_DEBUG ("Creating a RxTimingSetupReq command");
-                Ptr<RxTimingSetupReq> command = Create <RxTimingSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            case (0x09):
-              {
-                NS_LOG_DEBUG ("Creating a TxParamSetupReq command");
-                Ptr<TxParamSetupReq> command = Create <TxParamSetupReq> ();
-                byteNumber += command->Deserialize (start);
-                m_macCommands.push_back (command);
-                break;
-              }
-            default:
-              {
-                NS_LOG_ERROR ("CID not recognized during deserialization");
-              }
-            }
-        }
-    }
+  // FOpts field, parsed only when commands are requested
+  start.Read (m_fOpts.data (), m_fOptsLen);
 
   m_fPort = uint8_t (start.ReadU8 ());
 
@@ -337,7 +160,8 @@ LoraFrameHeader::Print (std::ostream &os) const
   os << "FOptsLen=" << unsigned(m_fOptsLen) << std::endl;
   os << "FCnt=" << unsigned(m_fCnt) << std::endl;
 
-  for (auto it = m_macCommands.begin (); it != m_macCommands.end (); it++)
+  std::list<Ptr<MacCommand> > commands = ParseCommands ();
+  for (auto it = commands.begin (); it != commands.end (); it++)
     {
       (*it)->Print (os);
     }
@@ -434,14 +258,7 @@ LoraFrameHeader::GetFPending (void) const
 uint8_t
 LoraFrameHeader::GetFOptsLen (void) const
 {
-  // Sum the serialized lenght of all commands in the list
-  uint8_t fOptsLen = 0;
-  std::list< Ptr< MacCommand> >::const_iterator it;
-  for (it = m_macCommands.begin (); it != m_macCommands.end (); it++)
-    {
-      fOptsLen = fOptsLen + (*it)->GetSerializedSize ();
-    }
-  return fOptsLen;
+  return m_fOptsLen;
 }
 
 void
@@ -461,11 +278,7 @@ LoraFrameHeader::AddLinkCheckReq (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  Ptr<LinkCheckReq> command = Create<LinkCheckReq> ();
-  m_macCommands.push_back (command);
-
-  NS_LOG_DEBUG ("Command SerializedSize: " << unsigned(command->GetSerializedSize ()));
-  m_fOptsLen += command->GetSerializedSize ();
+  AppendCommand (LINK_CHECK_REQ);
 }
 
 void
@@ -473,10 +286,9 @@ LoraFrameHeader::AddLinkCheckAns (uint8_t margin, uint8_t gwCnt)
 {
   NS_LOG_FUNCTION (this << unsigned(margin) << unsigned(gwCnt));
 
-  Ptr<LinkCheckAns> command = Create<LinkCheckAns> (margin, gwCnt);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  uint8_t *fields = AppendCommand (LINK_CHECK_ANS);
+  fields[0] = margin;
+  fields[1] = gwCnt;
 }
 
 void
@@ -496,10 +308,12 @@ LoraFrameHeader::AddLinkAdrReq (uint8_t dataRate, uint8_t txPower, std::list<int
 
   NS_LOG_DEBUG ("Creating LinkAdrReq with: DR = " << unsigned(dataRate) << " and txPower = " << unsigned(txPower));
 
-  Ptr<LinkAdrReq> command = Create<LinkAdrReq> (dataRate, txPower, channelMask, 0, repetitions);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  // Same layout as LinkAdrReq::Serialize, which writes the mask LSB first
+  uint8_t *fields = AppendCommand (LINK_ADR_REQ);
+  fields[0] = dataRate << 4 | (txPower & 0b1111);
+  fields[1] = channelMask & 0xff;
+  fields[2] = channelMask >> 8;
+  fields[3] = repetitions & 0b1111;
 }
 
 void
@@ -507,10 +321,9 @@ LoraFrameHeader::AddLinkAdrAns (bool powerAck, bool dataRateAck, bool channelMas
 {
   NS_LOG_FUNCTION (this << powerAck << dataRateAck << channelMaskAck);
 
-  Ptr<LinkAdrAns> command = Create<LinkAdrAns> (powerAck, dataRateAck, channelMaskAck);
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  uint8_t *fields = AppendCommand (LINK_ADR_ANS);
+  fields[0] = (uint8_t (powerAck) << 2) | (uint8_t (dataRateAck) << 1) |
+    uint8_t (channelMaskAck);
 }
 
 void
@@ -518,11 +331,8 @@ LoraFrameHeader::AddDutyCycleReq (uint8_t dutyCycle)
 {
   NS_LOG_FUNCTION (this << unsigned (dutyCycle));
 
-  Ptr<DutyCycleReq> command = Create<DutyCycleReq> (dutyCycle);
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  uint8_t *fields = AppendCommand (DUTY_CYCLE_REQ);
+  fields[0] = dutyCycle;
 }
 
 void
@@ -530,11 +340,7 @@ LoraFrameHeader::AddDutyCycleAns (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<DutyCycleAns> command = Create<DutyCycleAns> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  AppendCommand (DUTY_CYCLE_ANS);
 }
 
 void
@@ -546,13 +352,9 @@ LoraFrameHeader::AddRxParamSetupReq (uint8_t rx1DrOffset, uint8_t rx2DataRate, d
   // Evaluate whether to eliminate this assert in case new offsets can be defined.
   NS_ASSERT (0 <= rx1DrOffset && rx1DrOffset <= 5);
 
-  Ptr<RxParamSetupReq> command = Create<RxParamSetupReq> (rx1DrOffset,
-                                                          rx2DataRate,
-                                                          frequency);
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  uint8_t *fields = AppendCommand (RX_PARAM_SETUP_REQ);
+  fields[0] = (rx1DrOffset & 0b111) << 4 | (rx2DataRate & 0b1111);
+  WriteFrequency (fields + 1, frequency);
 }
 
 void
@@ -560,11 +362,9 @@ LoraFrameHeader::AddRxParamSetupAns (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<RxParamSetupAns> command = Create<RxParamSetupAns> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  // No acknowledgment bit is set
+  uint8_t *fields = AppendCommand (RX_PARAM_SETUP_ANS);
+  fields[0] = 0;
 }
 
 void
@@ -572,11 +372,7 @@ LoraFrameHeader::AddDevStatusReq (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<DevStatusReq> command = Create<DevStatusReq> ();
-
-  m_macCommands.push_back (command);
-
-  m_fOptsLen += command->GetSerializedSize ();
+  AppendCommand (DEV_STATUS_REQ);
 }
 
 void
@@ -585,12 +381,304 @@ LoraFrameHeader::AddNewChannelReq (uint8_t chIndex, double frequency,
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<NewChannelReq> command = Create<NewChannelReq> (chIndex, frequency,
-                                                      minDataRate, maxDataRate);
+  uint8_t *fields = AppendCommand (NEW_CHANNEL_REQ);
+  fields[0] = chIndex;
+  WriteFrequency (fields + 1, frequency);
+  fields[4] = (maxDataRate << 4) | (minDataRate & 0xf);
+}
+
+uint8_t *
+LoraFrameHeader::AppendCommand (enum MacCommandType commandType)
+{
+  uint8_t size = GetCommandSize (commandType);
+  NS_ASSERT_MSG (m_fOptsLen + size <= m_maxFOptsLen,
+                 "MAC commands don't fit in the 15 bytes of FOpts");
 
-  m_macCommands.push_back (command);
+  uint8_t *command = m_fOpts.data () + m_fOptsLen;
+  command[0] = MacCommand::GetCIDFromMacCommand (commandType);
+  m_fOptsLen += size;
 
-  m_fOptsLen += command->GetSerializedSize ();
+  // Return the first byte after the CID
+  return command + 1;
+}
+
+void
+LoraFrameHeader::WriteFrequency (uint8_t *fields, double frequency)
+{
+  // Encoded in units of 100 Hz, most significant byte first
+  uint32_t encodedFrequency = uint32_t (frequency / 100);
+  fields[0] = (encodedFrequency & 0xff0000) >> 16;
+  fields[1] = (encodedFrequency & 0xff00) >> 8;
+  fields[2] = encodedFrequency & 0xff;
+}
+
+enum MacCommandType
+LoraFrameHeader::GetCommandType (uint8_t cid) const
+{
+  // Uplinks carry the answers to the network's requests, except for the
+  // LinkCheckReq, and downlinks the opposite
+  switch (cid)
+    {
+    case (0x02):
+      return m_isUplink ? LINK_CHECK_REQ : LINK_CHECK_ANS;
+    case (0x03):
+      return m_isUplink ? LINK_ADR_ANS : LINK_ADR_REQ;
+    case (0x04):
+      return m_isUplink ? DUTY_CYCLE_ANS : DUTY_CYCLE_REQ;
+    case (0x05):
+      return m_isUplink ? RX_PARAM_SETUP_ANS : RX_PARAM_SETUP_REQ;
+    case (0x06):
+      return m_isUplink ? DEV_STATUS_ANS : DEV_STATUS_REQ;
+    case (0x07):
+      return m_isUplink ? NEW_CHANNEL_ANS : NEW_CHANNEL_REQ;
+    case (0x08):
+      return m_isUplink ? RX_TIMING_SETUP_ANS : RX_TIMING_SETUP_REQ;
+    case (0x09):
+      return m_isUplink ? TX_PARAM_SETUP_ANS : TX_PARAM_SETUP_REQ;
+    case (0x0A):
+      return m_isUplink ? DL_CHANNEL_ANS : INVALID;
+    default:
+      return INVALID;
+    }
+}
+
+uint8_t
+LoraFrameHeader::GetCommandSize (enum MacCommandType commandType)
+{
+  // The serialized sizes of the MacCommand classes
+  switch (commandType)
+    {
+    case (LINK_CHECK_REQ):
+    case (DUTY_CYCLE_ANS):
+    case (DEV_STATUS_REQ):
+    case (RX_TIMING_SETUP_ANS):
+    case (TX_PARAM_SETUP_REQ):
+    case (TX_PARAM_SETUP_ANS):
+    case (DL_CHANNEL_ANS):
+      return 1;
+    case (LINK_ADR_ANS):
+    case (DUTY_CYCLE_REQ):
+    case (RX_PARAM_SETUP_ANS):
+    case (NEW_CHANNEL_ANS):
+    case (RX_TIMING_SETUP_REQ):
+      return 2;
+    case (LINK_CHECK_ANS):
+    case (DEV_STATUS_ANS):
+      return 3;
+    case (LINK_ADR_REQ):
+    case (RX_PARAM_SETUP_REQ):
+      return 5;
+    case (NEW_CHANNEL_REQ):
+      return 6;
+    default:
+      return 0;
+    }
+}
+
+void
+LoraFrameHeader::ReadCommand (uint8_t offset, Ptr<MacCommand> command) const
+{
+  NS_LOG_FUNCTION (this << unsigned (offset) << command);
+
+  // MacCommand objects are read from a buffer
+  uint8_t size = GetCommandSize (command->GetCommandType ());
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator start = buffer.Begin ();
+  start.Write (m_fOpts.data () + offset, size);
+  start = buffer.Begin ();
+  command->Deserialize (start);
+}
+
+std::list<Ptr<MacCommand> >
+LoraFrameHeader::ParseCommands (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  std::list<Ptr<MacCommand> > commands;
+
+  // MacCommand objects are read from a buffer
+  Buffer buffer;
+  buffer.AddAtStart (m_fOptsLen);
+  Buffer::Iterator start = buffer.Begin ();
+  start.Write (m_fOpts.data (), m_fOptsLen);
+  start = buffer.Begin ();
+
+  NS_LOG_DEBUG ("Starting deserialization of MAC commands");
+  for (uint8_t byteNumber = 0; byteNumber < m_fOptsLen;)
+    {
+      uint8_t cid = start.PeekU8 ();
+      NS_LOG_DEBUG ("CID: " << unsigned(cid));
+
+      // Divide Uplink and Downlink messages
+      // This needs to be done because they have the same CID, and the context
+      // about where this message will be Serialized/Deserialized (i.e., at the
+      // ED or at the NS) is umportant.
+      if (m_isUplink)
+        {
+          switch (cid)
+            {
+            // In the case of Uplink messages, the NS will deserialize the
+            // request for a link check
+            case (0x02):
+              {
+                NS_LOG_DEBUG ("Creating a LinkCheckReq command");
+                Ptr<LinkCheckReq> command = Create <LinkCheckReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x03):
+              {
+                NS_LOG_DEBUG ("Creating a LinkAdrAns command");
+                Ptr<LinkAdrAns> command = Create <LinkAdrAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x04):
+              {
+                NS_LOG_DEBUG ("Creating a DutyCycleAns command");
+                Ptr<DutyCycleAns> command = Create <DutyCycleAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x05):
+              {
+                NS_LOG_DEBUG ("Creating a RxParamSetupAns command");
+                Ptr<RxParamSetupAns> command = Create <RxParamSetupAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x06):
+              {
+                NS_LOG_DEBUG ("Creating a DevStatusAns command");
+                Ptr<DevStatusAns> command = Create <DevStatusAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x07):
+              {
+                NS_LOG_DEBUG ("Creating a NewChannelAns command");
+                Ptr<NewChannelAns> command = Create <NewChannelAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x08):
+              {
+                NS_LOG_DEBUG ("Creating a RxTimingSetupAns command");
+                Ptr<RxTimingSetupAns> command = Create <RxTimingSetupAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x09):
+              {
+                NS_LOG_DEBUG ("Creating a TxParamSetupAns command");
+                Ptr<TxParamSetupAns> command = Create <TxParamSetupAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x0A):
+              {
+                NS_LOG_DEBUG ("Creating a DlChannelAns command");
+                Ptr<DlChannelAns> command = Create <DlChannelAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            default:
+              {
+                NS_LOG_ERROR ("CID not recognized during deserialization");
+                return commands;
+              }
+            }
+        }
+      else
+        {
+          switch (cid)
+            {
+            // In the case of Downlink messages, the ED will deserialize the
+            // answer to a link check
+            case (0x02):
+              {
+                NS_LOG_DEBUG ("Creating a LinkCheckAns command");
+                Ptr<LinkCheckAns> command = Create <LinkCheckAns> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x03):
+              {
+                NS_LOG_DEBUG ("Creating a LinkAdrReq command");
+                Ptr<LinkAdrReq> command = Create <LinkAdrReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x04):
+              {
+                NS_LOG_DEBUG ("Creating a DutyCycleReq command");
+                Ptr<DutyCycleReq> command = Create <DutyCycleReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x05):
+              {
+                NS_LOG_DEBUG ("Creating a RxParamSetupReq command");
+                Ptr<RxParamSetupReq> command = Create <RxParamSetupReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x06):
+              {
+                NS_LOG_DEBUG ("Creating a DevStatusReq command");
+                Ptr<DevStatusReq> command = Create <DevStatusReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x07):
+              {
+                NS_LOG_DEBUG ("Creating a NewChannelReq command");
+                Ptr<NewChannelReq> command = Create <NewChannelReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x08):
+              {
+                NS_LOG_DEBUG ("Creating a RxTimingSetupReq command");
+                Ptr<RxTimingSetupReq> command = Create <RxTimingSetupReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            case (0x09):
+              {
+                NS_LOG_DEBUG ("Creating a TxParamSetupReq command");
+                Ptr<TxParamSetupReq> command = Create <TxParamSetupReq> ();
+                byteNumber += command->Deserialize (start);
+                commands.push_back (command);
+                break;
+              }
+            default:
+              {
+                NS_LOG_ERROR ("CID not recognized during deserialization");
+                return commands;
+              }
+            }
+        }
+    }
+
+  return commands;
 }
 
 std::list<Ptr<MacCommand> >
@@ -598,7 +686,7 @@ LoraFrameHeader::GetCommands (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  return m_macCommands;
+  return ParseCommands ();
 }
 
 void
@@ -606,8 +694,19 @@ LoraFrameHeader::AddCommand (Ptr<MacCommand> macCommand)
 {
   NS_LOG_FUNCTION (this << macCommand);
 
-  m_macCommands.push_back (macCommand);
-  m_fOptsLen += macCommand->GetSerializedSize ();
+  uint8_t size = macCommand->GetSerializedSize ();
+  NS_ASSERT_MSG (m_fOptsLen + size <= m_maxFOptsLen,
+                 "MAC commands don't fit in the 15 bytes of FOpts");
+
+  // Store the command in its serialized form
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator start = buffer.Begin ();
+  macCommand->Serialize (start);
+  start = buffer.Begin ();
+  start.Read (m_fOpts.data () + m_fOptsLen, size);
+
+  m_fOptsLen += size;
 }
 
 }
@@ -24,6 +24,7 @@
 #include "ns3/header.h"
 #include "ns3/lora-device-address.h"
 #include "ns3/mac-command.h"
+#include <array>
 
 namespace ns3 {
 namespace lorawan {
@@ -208,9 +209,12 @@ public:
   /**
    * Return a pointer to a MacCommand, or 0 if the MacCommand does not exist
    * in this header.
+   *
+   * Only the CIDs in FOpts are scanned, and only the requested command is
+   * created.
    */
   template<typename T>
-  inline Ptr<T> GetMacCommand (void);
+  inline Ptr<T> GetMacCommand (void) const;
 
   /**
    * Add a LinkCheckReq command.
@@ -287,6 +291,9 @@ public:
 
   /**
    * Return a list of pointers to all the MAC commands saved in this header.
+   *
+   * Commands are stored in their serialized form, so each call creates new
+   * MacCommand objects.
    */
   std::list<Ptr<MacCommand> > GetCommands (void);
 
@@ -296,6 +303,57 @@ public:
   void AddCommand (Ptr<MacCommand> macCommand);
 
 private:
+  /**
+   * Create the MacCommand objects corresponding to the content of m_fOpts.
+   *
+   * \return The list of commands, in the order they appear in FOpts.
+   */
+  std::list<Ptr<MacCommand> > ParseCommands (void) const;
+
+  /**
+   * Append a command to FOpts, writing its CID.
+   *
+   * \param commandType The type of the command.
+   * \return A pointer to the bytes of FOpts following the CID, where the
+   * fields of the command are to be written.
+   */
+  uint8_t *AppendCommand (enum MacCommandType commandType);
+
+  /**
+   * Write a frequency in the 3-byte form used by MAC commands.
+   *
+   * \param fields The first of the three bytes to write.
+   * \param frequency The frequency, in Hz.
+   */
+  static void WriteFrequency (uint8_t *fields, double frequency);
+
+  /**
+   * Get the type of the command a CID stands for in this header, which
+   * depends on the direction of the frame.
+   *
+   * \param cid The CID.
+   * \return The command type, or INVALID if the CID is not recognized.
+   */
+  enum MacCommandType GetCommandType (uint8_t cid) const;
+
+  /**
+   * Get the serialized size of a command, including its CID.
+   *
+   * \param commandType The type of the command.
+   * \return The size in bytes, or 0 for unknown types.
+   */
+  static uint8_t GetCommandSize (enum MacCommandType commandType);
+
+  /**
+   * Deserialize a command stored in FOpts.
+   *
+   * \param offset The position of the CID of the command in FOpts.
+   * \param command The command to fill, of the type found at offset.
+   */
+  void ReadCommand (uint8_t offset, Ptr<MacCommand> command) const;
+
+  static const uint8_t m_maxFOptsLen = 15; //!< The maximum length of FOpts
+
   uint8_t m_fPort;
 
   LoraDeviceAddress m_address;
@@ -308,13 +366,11 @@ private:
 
   uint16_t m_fCnt;
 
-  Buffer m_fOpts;
-
   /**
-   * List containing all the MacCommand instances that are contained in this
-   * LoraFrameHeader.
+   * The MAC commands contained in this LoraFrameHeader, in their serialized
+   * form. Only the first m_fOptsLen bytes are used.
    */
-  std::list< Ptr< MacCommand> > m_macCommands;
+  std::array<uint8_t, m_maxFOptsLen> m_fOpts;
 
   bool m_isUplink;
 };
@@ -322,16 +378,29 @@ private:
 
 template<typename T>
 Ptr<T>
-LoraFrameHeader::GetMacCommand ()
+LoraFrameHeader::GetMacCommand () const
 {
-  // Iterate on MAC commands and try casting
-  std::list< Ptr< MacCommand> >::const_iterator it;
-  for (it = m_macCommands.begin (); it != m_macCommands.end (); ++it)
+  // The command is only created once FOpts is known not to be empty, to get
+  // its type
+  Ptr<T> command;
+  for (uint8_t offset = 0; offset < m_fOptsLen;)
     {
-      if ((*it)->GetObject<T> () != 0)
+      enum MacCommandType commandType = GetCommandType (m_fOpts[offset]);
+      if (commandType == INVALID || offset + GetCommandSize (commandType) > m_fOptsLen)
+        {
+          break;
+        }
+
+      if (command == 0)
+        {
+          command = Create<T> ();
+        }
+      if (commandType == command->GetCommandType ())
         {
-          return (*it)->GetObject<T> ();
+          ReadCommand (offset, command);
+          return command;
         }
+      offset += GetCommandSize (commandType);
     }
 
   // If no command was found, return 0
@@ -21,6 +21,8 @@
 #include "ns3/lora-interference-helper.h"
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace ns3 {
@@ -40,8 +42,11 @@ LoraInterferenceHelper::Event::Event (Time duration, double rxPowerdBm, uint8_t
       m_sf (spreadingFactor),
       m_rxPowerdBm (rxPowerdBm),
       m_packet (packet),
-      m_frequencyMHz (frequencyMHz)
+      m_frequencyMHz (frequencyMHz),
+      m_receptionPath (-1)
 {
+  // Power [W] = 10^(Power[dBm]/10) / 1000
+  m_rxPowerW = pow (10, rxPowerdBm / 10) / 1000;
   // NS_LOG_FUNCTION_NOARGS ();
 }
 
@@ -76,6 +81,12 @@ LoraInterferenceHelper::Event::GetRxPowerdBm (void) const
   return m_rxPowerdBm;
 }
 
+double
+LoraInterferenceHelper::Event::GetRxPowerW (void) const
+{
+  return m_rxPowerW;
+}
+
 uint8_t
 LoraInterferenceHelper::Event::GetSpreadingFactor (void) const
 {
@@ -94,6 +105,131 @@ LoraInterferenceHelper::Event::GetFrequency (void) const
   return m_frequencyMHz;
 }
 
+void
+LoraInterferenceHelper::Event::SetReceptionPath (int32_t index)
+{
+  m_receptionPath = index;
+}
+
+int32_t
+LoraInterferenceHelper::Event::GetReceptionPath (void) const
+{
+  return m_receptionPath;
+}
+
+void *LoraInterferenceHelper::Event::freeList = 0;
+void *LoraInterferenceHelper::Event::chunkList = 0;
+std::size_t LoraInterferenceHelper::Event::liveEvents = 0;
+bool LoraInterferenceHelper::Event::released = false;
+
+/**
+ * Releases the event pool when static objects are destroyed at program exit.
+ *
+ * The pool itself only uses trivially destructible statics, so that events
+ * destroyed later (e.g., by other static objects) can still be returned to it.
+ */
+struct EventPoolReleaser
+{
+  ~EventPoolReleaser ()
+  {
+    LoraInterferenceHelper::Event::ReleasePool ();
+  }
+};
+
+static EventPoolReleaser g_eventPoolReleaser;
+
+/**
+ * The size of a block of the pool: blocks must be able to hold a pointer and
+ * keep the event's alignment.
+ */
+static std::size_t
+GetEventBlockSize (void)
+{
+  std::size_t blockSize = std::max (sizeof (LoraInterferenceHelper::Event), sizeof (void *));
+  return (blockSize + alignof (LoraInterferenceHelper::Event) - 1) /
+         alignof (LoraInterferenceHelper::Event) * alignof (LoraInterferenceHelper::Event);
+}
+
+void *
+LoraInterferenceHelper::Event::operator new (std::size_t size)
+{
+  // Only events of this exact type can be pooled
+  if (size != sizeof (LoraInterferenceHelper::Event))
+    {
+      return ::operator new (size);
+    }
+
+  if (freeList == 0)
+    {
+      // Carve a new chunk into blocks and link them in the free list. The
+      // first block links the chunk in the chunk list, so that all chunks can
+      // be freed at exit.
+      std::size_t blockSize = GetEventBlockSize ();
+      char *chunk = static_cast<char *> (::operator new (blockSize * (chunkSize + 1)));
+      *reinterpret_cast<void **> (chunk) = chunkList;
+      chunkList = chunk;
+      for (std::size_t i = 1; i <= chunkSize; i++)
+        {
+          void *block = chunk + i * blockSize;
+          *static_cast<void **> (block) = freeList;
+          freeList = block;
+        }
+    }
+
+  void *block = freeList;
+  freeList = *static_cast<void **> (block);
+  liveEvents++;
+  return block;
+}
+
+void
+LoraInterferenceHelper::Event::operator delete (void *pointer, std::size_t size)
+{
+  if (pointer == 0)
+    {
+      return;
+    }
+
+  if (size != sizeof (LoraInterferenceHelper::Event))
+    {
+      ::operator delete (pointer);
+      return;
+    }
+
+  *static_cast<void **> (pointer) = freeList;
+  freeList = pointer;
+  liveEvents--;
+
+  if (released)
+    {
+      ReleaseChunksIfUnused ();
+    }
+}
+
+void
+LoraInterferenceHelper::Event::ReleasePool (void)
+{
+  released = true;
+  ReleaseChunksIfUnused ();
+}
+
+void
+LoraInterferenceHelper::Event::ReleaseChunksIfUnused (void)
+{
+  if (liveEvents > 0)
+    {
+      return;
+    }
+
+  while (chunkList != 0)
+    {
+      void *chunk = chunkList;
+      chunkList = *static_cast<void **> (chunk);
+      ::operator delete (chunk);
+    }
+  freeList = 0;
+}
+
 void
 LoraInterferenceHelper::Event::Print (std::ostream &stream) const
 {
@@ -142,23 +278,37 @@ std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirAloha= {
 LoraInterferenceHelper::CollisionMatrix LoraInterferenceHelper::collisionMatrix =
     LoraInterferenceHelper::GOURSAUD;
 
+bool LoraInterferenceHelper::incrementalEnergy = false;
+
 NS_OBJECT_ENSURE_REGISTERED (LoraInterferenceHelper);
 
 void
 LoraInterferenceHelper::SetCollisionMatrix (
     enum LoraInterferenceHelper::CollisionMatrix collisionMatrix)
 {
+  const std::vector<std::vector<double>> *matrix = &LoraInterferenceHelper::collisionSnirGoursaud;
   switch (collisionMatrix)
     {
     case LoraInterferenceHelper::ALOHA:
       NS_LOG_DEBUG ("Setting the ALOHA collision matrix");
-      m_collisionSnir = LoraInterferenceHelper::collisionSnirAloha;
+      matrix = &LoraInterferenceHelper::collisionSnirAloha;
       break;
     case LoraInterferenceHelper::GOURSAUD:
       NS_LOG_DEBUG ("Setting the GOURSAUD collision matrix");
-      m_collisionSnir = LoraInterferenceHelper::collisionSnirGoursaud;
+      matrix = &LoraInterferenceHelper::collisionSnirGoursaud;
       break;
     }
+
+  // Flatten the matrix, and keep a copy in linear units so that the SNIR
+  // check can be done without logarithms
+  for (unsigned i = 0; i < 6; i++)
+    {
+      for (unsigned j = 0; j < 6; j++)
+        {
+          m_collisionSnir[i * 6 + j] = (*matrix)[i][j];
+          m_collisionSnirLinear[i * 6 + j] = std::pow (10, (*matrix)[i][j] / 10);
+        }
+    }
 }
 
 TypeId
@@ -170,7 +320,7 @@ LoraInterferenceHelper::GetTypeId (void)
   return tid;
 }
 
-  LoraInterferenceHelper::LoraInterferenceHelper () : m_collisionSnir(LoraInterferenceHelper::collisionSnirGoursaud)
+LoraInterferenceHelper::LoraInterferenceHelper () : m_maxDuration (Seconds (0))
 {
   NS_LOG_FUNCTION (this);
 
@@ -196,15 +346,45 @@ LoraInterferenceHelper::Add (Time duration, double rxPower, uint8_t spreadingFac
   Ptr<LoraInterferenceHelper::Event> event = Create<LoraInterferenceHelper::Event> (
       duration, rxPower, spreadingFactor, packet, frequencyMHz);
 
-  // Add the event to the list
-  m_events.push_back (event);
+  // Add the event to the queue of its frequency, keeping it sorted by start
+  // time. Events are usually added in order, unless time went back because of
+  // a new simulation run.
+  std::deque<Ptr<LoraInterferenceHelper::Event>> &events = m_events[frequencyMHz];
+  if (events.empty () || events.back ()->GetStartTime () <= event->GetStartTime ())
+    {
+      events.push_back (event);
+    }
+  else
+    {
+      events.insert (std::upper_bound (events.begin (), events.end (), event,
+                                       [] (const Ptr<LoraInterferenceHelper::Event> &a,
+                                           const Ptr<LoraInterferenceHelper::Event> &b)
+                                       { return a->GetStartTime () < b->GetStartTime (); }),
+                     event);
+    }
+
+  m_maxDuration = std::max (m_maxDuration, duration);
 
-  // Clean the event list
-  if (m_events.size () > 100)
+  // Add the energy of the new event to the receptions we are locked on
+  for (auto it = m_lockedEvents.begin (); it != m_lockedEvents.end ();)
     {
-      CleanOldEvents ();
+      // Receptions that were interrupted are never checked: forget them
+      if (it->event->GetEndTime () < Simulator::Now ())
+        {
+          it = m_lockedEvents.erase (it);
+          continue;
+        }
+      if (it->event->GetFrequency () == frequencyMHz)
+        {
+          it->energy[unsigned (spreadingFactor) - 7] +=
+              GetOverlapTime (it->event, event).GetSeconds () * event->GetRxPowerW ();
+        }
+      it++;
     }
 
+  // Clean the event queues
+  CleanOldEvents ();
+
   return event;
 }
 
@@ -213,16 +393,16 @@ LoraInterferenceHelper::CleanOldEvents (void)
 {
   NS_LOG_FUNCTION (this);
 
-  // Cycle the events, and clean up if an event is old.
-  for (auto it = m_events.begin (); it != m_events.end ();)
+  // Events are sorted by start time: pop them from the front of each queue as
+  // long as they are old. Events that ended early but started after a longer
+  // one are removed as soon as that one is.
+  Time threshold = std::max (oldEventThreshold, m_maxDuration);
+  for (auto &channel : m_events)
     {
-      if ((*it)->GetEndTime () + oldEventThreshold < Simulator::Now ())
+      std::deque<Ptr<LoraInterferenceHelper::Event>> &events = channel.second;
+      while (!events.empty () && events.front ()->GetEndTime () + threshold < Simulator::Now ())
         {
-          it = m_events.erase (it);
-        }
-      else
-        {
-          it++;
+          events.pop_front ();
         }
     }
 }
@@ -230,7 +410,12 @@ LoraInterferenceHelper::CleanOldEvents (void)
 std::list<Ptr<LoraInterferenceHelper::Event>>
 LoraInterferenceHelper::GetInterferers ()
 {
-  return m_events;
+  std::list<Ptr<LoraInterferenceHelper::Event>> interferers;
+  for (auto &channel : m_events)
+    {
+      interferers.insert (interferers.end (), channel.second.begin (), channel.second.end ());
+    }
+  return interferers;
 }
 
 void
@@ -240,11 +425,33 @@ LoraInterferenceHelper::PrintEvents (std::ostream &stream)
 
   stream << "Currently registered events:" << std::endl;
 
-  for (auto it = m_events.begin (); it != m_events.end (); it++)
+  for (auto &channel : m_events)
+    {
+      for (auto it = channel.second.begin (); it != channel.second.end (); it++)
+        {
+          (*it)->Print (stream);
+          stream << std::endl;
+        }
+    }
+}
+
+void
+LoraInterferenceHelper::TrackEvent (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  if (!incrementalEnergy)
     {
-      (*it)->Print (stream);
-      stream << std::endl;
+      return;
     }
+
+  // Start from the interference of the events that are already on the air:
+  // the ones that come later are accounted for when they are added
+  LockedEvent locked;
+  locked.event = event;
+  locked.energy = std::vector<double> (6, 0);
+  GetInterferenceEnergy (event, locked.energy);
+  m_lockedEvents.push_back (locked);
 }
 
 uint8_t
@@ -252,43 +459,62 @@ LoraInterferenceHelper::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::E
 {
   NS_LOG_FUNCTION (this << event);
 
-  NS_LOG_INFO ("Current number of events in LoraInterferenceHelper: " << m_events.size ());
+  // If we kept track of the interference as it arrived, we are done
+  for (auto it = m_lockedEvents.begin (); it != m_lockedEvents.end (); it++)
+    {
+      if (it->event == event)
+        {
+          std::vector<double> cumulativeInterferenceEnergy = it->energy;
+          m_lockedEvents.erase (it);
+          return IsDestroyedByInterference (event, cumulativeInterferenceEnergy);
+        }
+    }
 
-  // We want to see the interference affecting this event: cycle through events
-  // that overlap with this one and see whether it survives the interference or
-  // not.
+  // Energy for interferers of various SFs
+  std::vector<double> cumulativeInterferenceEnergy (6, 0);
+  GetInterferenceEnergy (event, cumulativeInterferenceEnergy);
 
-  // Gather information about the event
-  double rxPowerDbm = event->GetRxPowerdBm ();
-  uint8_t sf = event->GetSpreadingFactor ();
-  double frequency = event->GetFrequency ();
+  return IsDestroyedByInterference (event, cumulativeInterferenceEnergy);
+}
 
-  // Handy information about the time frame when the packet was received
-  Time now = Simulator::Now ();
-  Time duration = event->GetDuration ();
-  Time packetStartTime = now - duration;
-  Time packetEndTime = now;
+void
+LoraInterferenceHelper::GetInterferenceEnergy (Ptr<LoraInterferenceHelper::Event> event,
+                                               std::vector<double> &cumulativeInterferenceEnergy)
+{
+  NS_LOG_FUNCTION (this << event);
 
-  // Get the list of interfering events
-  std::list<Ptr<LoraInterferenceHelper::Event>>::iterator it;
+  // We want to see the interference affecting this event: cycle through events
+  // that overlap with this one and sum up their energy.
 
-  // Energy for interferers of various SFs
-  std::vector<double> cumulativeInterferenceEnergy (6, 0);
+  // Only consider events on the same channel: we assume there's no
+  // interchannel interference.
+  auto channel = m_events.find (event->GetFrequency ());
+  if (channel == m_events.end ())
+    {
+      return;
+    }
+  std::deque<Ptr<LoraInterferenceHelper::Event>> &events = channel->second;
+
+  NS_LOG_INFO ("Current number of events on this channel: " << events.size ());
 
-  // Cycle over the events
-  for (it = m_events.begin (); it != m_events.end ();)
+  // Events starting earlier than this cannot overlap with ours
+  Time earliestStart = event->GetStartTime () - m_maxDuration;
+  std::deque<Ptr<LoraInterferenceHelper::Event>>::iterator it =
+      std::lower_bound (events.begin (), events.end (), earliestStart,
+                        [] (const Ptr<LoraInterferenceHelper::Event> &e, const Time &t)
+                        { return e->GetStartTime () < t; });
+
+  // Cycle over the events that start before ours ends
+  for (; it != events.end () && (*it)->GetStartTime () < event->GetEndTime (); it++)
     {
       // Pointer to the current interferer
-      Ptr<LoraInterferenceHelper::Event> interferer = *it;
+      const Ptr<LoraInterferenceHelper::Event> &interferer = *it;
 
-      // Only consider the current event if the channel is the same: we
-      // assume there's no interchannel interference. Also skip the current
-      // event if it's the same that we want to analyze.
-      if (!(interferer->GetFrequency () == frequency) || interferer == event)
+      // Skip the current event if it's the same that we want to analyze.
+      if (interferer == event)
         {
-          NS_LOG_DEBUG ("Different channel or same event");
-          it++;
-          continue; // Continues from the first line inside the for cycle
+          NS_LOG_DEBUG ("Same event");
+          continue;
         }
 
       NS_LOG_DEBUG ("Interferer on same channel");
@@ -310,53 +536,130 @@ LoraInterferenceHelper::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::E
       NS_LOG_DEBUG ("The two events overlap for " << overlap.GetSeconds () << " s.");
 
       // Compute the equivalent energy of the interference
-      // Power [mW] = 10^(Power[dBm]/10)
-      // Power [W] = Power [mW] / 1000
-      double interfererPowerW = pow (10, interfererPower / 10) / 1000;
+      double interfererPowerW = interferer->GetRxPowerW ();
       // Energy [J] = Time [s] * Power [W]
       double interferenceEnergy = overlap.GetSeconds () * interfererPowerW;
       cumulativeInterferenceEnergy.at (unsigned(interfererSf) - 7) += interferenceEnergy;
       NS_LOG_DEBUG ("Interferer power in W: " << interfererPowerW);
       NS_LOG_DEBUG ("Interference energy: " << interferenceEnergy);
-      it++;
     }
+}
+
+uint8_t
+LoraInterferenceHelper::IsDestroyedByInterference (
+    Ptr<LoraInterferenceHelper::Event> event,
+    const std::vector<double> &cumulativeInterferenceEnergy)
+{
+  NS_LOG_FUNCTION (this << event);
 
-  // For each SF, check if there was destructive interference
-  for (uint8_t currentSf = uint8_t (7); currentSf <= uint8_t (12); currentSf++)
+  NS_ASSERT (cumulativeInterferenceEnergy.size () >= 6);
+
+  uint8_t sf = event->GetSpreadingFactor ();
+
+  // The energy of the signal we want to receive
+  double signalPowerW = event->GetRxPowerW ();
+  double signalEnergy = event->GetDuration ().GetSeconds () * signalPowerW;
+  NS_LOG_DEBUG ("Signal power in W: " << signalPowerW);
+  NS_LOG_DEBUG ("Signal energy: " << signalEnergy);
+
+  uint8_t destroyingSf = Score (signalEnergy, &m_collisionSnirLinear[(unsigned (sf) - 7) * 6],
+                                cumulativeInterferenceEnergy.data ());
+
+  if (destroyingSf == 0)
+    {
+      NS_LOG_DEBUG ("Packet survived all interference");
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Packet destroyed by interference with SF"
+                    << unsigned (destroyingSf) << ": interference energy "
+                    << cumulativeInterferenceEnergy[unsigned (destroyingSf) - 7]
+                    << ", needed isolation "
+                    << m_collisionSnir[(unsigned (sf) - 7) * 6 + unsigned (destroyingSf) - 7]
+                    << " dB");
+    }
+
+  return destroyingSf;
+}
+
+void
+LoraInterferenceHelper::IsDestroyedByInterference (
+    const std::vector<Ptr<LoraInterferenceHelper::Event>> &events, std::vector<uint8_t> &outcomes)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+
+  // Gather the interference energy of all events first
+  std::vector<double> cumulativeInterferenceEnergy (6 * events.size (), 0);
+  std::vector<double> energy (6);
+  for (std::size_t i = 0; i < events.size (); i++)
     {
-      NS_LOG_DEBUG ("Cumulative Interference Energy: "
-                    << cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-
-      // Use the computed cumulativeInterferenceEnergy to determine whether the
-      // interference with this SF destroys the packet
-      double signalPowerW = pow (10, rxPowerDbm / 10) / 1000;
-      double signalEnergy = duration.GetSeconds () * signalPowerW;
-      NS_LOG_DEBUG ("Signal power in W: " << signalPowerW);
-      NS_LOG_DEBUG ("Signal energy: " << signalEnergy);
-
-      // Check whether the packet survives the interference of this SF
-      double snirIsolation = m_collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7];
-      NS_LOG_DEBUG ("The needed isolation to survive is " << snirIsolation << " dB");
-      double snir =
-          10 * log10 (signalEnergy / cumulativeInterferenceEnergy.at (unsigned(currentSf) - 7));
-      NS_LOG_DEBUG ("The current SNIR is " << snir << " dB");
-
-      if (snir >= snirIsolation)
+      std::fill (energy.begin (), energy.end (), 0);
+
+      bool tracked = false;
+      for (auto it = m_lockedEvents.begin (); it != m_lockedEvents.end (); it++)
         {
-          // Move on and check the rest of the interferers
-          NS_LOG_DEBUG ("Packet survived interference with SF " << currentSf);
+          if (it->event == events[i])
+            {
+              energy = it->energy;
+              m_lockedEvents.erase (it);
+              tracked = true;
+              break;
+            }
         }
-      else
+      if (!tracked)
         {
-          NS_LOG_DEBUG ("Packet destroyed by interference with SF" << unsigned(currentSf));
-
-          return currentSf;
+          GetInterferenceEnergy (events[i], energy);
         }
+
+      std::copy (energy.begin (), energy.end (), cumulativeInterferenceEnergy.begin () + 6 * i);
     }
-  // If we get to here, it means that the packet survived all interference
-  NS_LOG_DEBUG ("Packet survived all interference");
 
-  // Since the packet was not destroyed, we return 0.
+  IsDestroyedByInterference (events, cumulativeInterferenceEnergy, outcomes);
+}
+
+void
+LoraInterferenceHelper::IsDestroyedByInterference (
+    const std::vector<Ptr<LoraInterferenceHelper::Event>> &events,
+    const std::vector<double> &cumulativeInterferenceEnergy, std::vector<uint8_t> &outcomes)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+
+  NS_ASSERT (cumulativeInterferenceEnergy.size () >= 6 * events.size ());
+
+  outcomes.resize (events.size ());
+  for (std::size_t i = 0; i < events.size (); i++)
+    {
+      const Ptr<LoraInterferenceHelper::Event> &event = events[i];
+      double signalEnergy = event->GetDuration ().GetSeconds () * event->GetRxPowerW ();
+      outcomes[i] = Score (signalEnergy,
+                           &m_collisionSnirLinear[(unsigned (event->GetSpreadingFactor ()) - 7) * 6],
+                           &cumulativeInterferenceEnergy[6 * i]);
+      NS_LOG_DEBUG ("Outcome of event " << event << ": " << unsigned (outcomes[i]));
+    }
+}
+
+uint8_t
+LoraInterferenceHelper::Score (double signalEnergy, const double *isolation, const double *energy)
+{
+  // The packet survives the interference of an SF if the SNIR is at least the
+  // isolation, i.e., if signalEnergy >= isolation * energy in linear units.
+  // No interference energy gives a product of 0 (or NaN for an infinite
+  // isolation), which never destroys the packet. The loop has no branches, so
+  // that all SFs are scored at once.
+  unsigned destroyed = 0;
+  for (unsigned i = 0; i < 6; i++)
+    {
+      destroyed |= unsigned (signalEnergy < isolation[i] * energy[i]) << i;
+    }
+
+  // Report the lowest SF that destroyed the packet
+  for (unsigned i = 0; i < 6; i++)
+    {
+      if (destroyed & (1u << i))
+        {
+          return uint8_t (7 + i);
+        }
+    }
   return uint8_t (0);
 }
 
@@ -366,11 +669,13 @@ LoraInterferenceHelper::ClearAllEvents (void)
   NS_LOG_FUNCTION_NOARGS ();
 
   m_events.clear ();
+  m_lockedEvents.clear ();
+  m_maxDuration = Seconds (0);
 }
 
 Time
-LoraInterferenceHelper::GetOverlapTime (Ptr<LoraInterferenceHelper::Event> event1,
-                                        Ptr<LoraInterferenceHelper::Event> event2)
+LoraInterferenceHelper::GetOverlapTime (const Ptr<LoraInterferenceHelper::Event> &event1,
+                                        const Ptr<LoraInterferenceHelper::Event> &event2)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -28,7 +28,10 @@
 #include "ns3/callback.h"
 #include "ns3/packet.h"
 #include "ns3/logical-lora-channel.h"
+#include <array>
 #include <list>
+#include <map>
+#include <deque>
 
 namespace ns3 {
 namespace lorawan {
@@ -77,6 +80,11 @@ public:
      */
     double GetRxPowerdBm (void) const;
 
+    /**
+     * Get the power of the event in W, computed once at construction.
+     */
+    double GetRxPowerW (void) const;
+
     /**
      * Get the spreading factor used by this signal.
      */
@@ -92,12 +100,86 @@ public:
      */
     double GetFrequency (void) const;
 
+    /**
+     * Set the index of the gateway reception path locked on this event.
+     *
+     * \param index The index of the reception path, or -1 if no reception
+     * path is locked on this event.
+     */
+    void SetReceptionPath (int32_t index);
+
+    /**
+     * Get the index of the gateway reception path locked on this event.
+     *
+     * \return The index of the reception path, or -1 if no reception path is
+     * locked on this event.
+     */
+    int32_t GetReceptionPath (void) const;
+
     /**
      * Print the current event in a human readable form.
      */
     void Print (std::ostream &stream) const;
 
+    /**
+     * Allocate memory for an event, reusing the memory of a destroyed event
+     * if possible.
+     *
+     * Events are created and destroyed at a very high rate, so they are
+     * allocated in chunks and recycled through a free list instead of going
+     * through the general purpose allocator each time. The chunks are
+     * released at program exit, once all events have been destroyed.
+     *
+     * \param size The size of the object to allocate.
+     * \return The allocated memory.
+     */
+    static void *operator new (std::size_t size);
+
+    /**
+     * Return the memory of an event to the free list.
+     *
+     * \param pointer The memory to release.
+     * \param size The size of the object.
+     */
+    static void operator delete (void *pointer, std::size_t size);
+
+    /**
+     * Release the chunks of the pool at program exit, as soon as no event is
+     * alive anymore.
+     */
+    static void ReleasePool (void);
+
   private:
+    /**
+     * Free the memory of all chunks, if no event is alive.
+     */
+    static void ReleaseChunksIfUnused (void);
+
+    /**
+     * The number of events allocated at once when the free list is empty.
+     */
+    static const std::size_t chunkSize = 1024;
+
+    /**
+     * The memory blocks of destroyed events, linked through their first bytes.
+     */
+    static void *freeList;
+
+    /**
+     * The allocated chunks, linked through their first block.
+     */
+    static void *chunkList;
+
+    /**
+     * The number of events currently allocated from the pool.
+     */
+    static std::size_t liveEvents;
+
+    /**
+     * Whether the pool must release its chunks when the last event is freed.
+     */
+    static bool released;
+
     /**
      * The time this signal begins (at the device).
      */
@@ -118,6 +200,11 @@ public:
      */
     double m_rxPowerdBm;
 
+    /**
+     * The power of this event in W (at the device).
+     */
+    double m_rxPowerW;
+
     /**
      * The packet this event was generated for.
      */
@@ -127,6 +214,11 @@ public:
      * The frequency this event was on.
      */
     double m_frequencyMHz;
+
+    /**
+     * The index of the gateway reception path locked on this event.
+     */
+    int32_t m_receptionPath;
   };
 
   enum CollisionMatrix {
@@ -175,6 +267,61 @@ public:
    */
   uint8_t IsDestroyedByInterference (Ptr<LoraInterferenceHelper::Event> event);
 
+  /**
+   * Notify the helper that the device locked on an event.
+   *
+   * If incrementalEnergy is set, the helper keeps the interference energy
+   * affecting the event up to date as new events are added, so that
+   * IsDestroyedByInterference does not need to go through the stored events.
+   * Otherwise, this method does nothing.
+   *
+   * \param event The event the device locked on.
+   */
+  void TrackEvent (Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Determine whether the event was destroyed by interference, given the
+   * interference energy that overlapped with it.
+   *
+   * \param event The event for which to check the outcome.
+   * \param cumulativeInterferenceEnergy The energy [J] of the interference
+   * overlapping with the event, for each SF from 7 to 12.
+   * \return The sf of the packets that caused the loss, or 0 if there was no
+   * loss.
+   */
+  uint8_t IsDestroyedByInterference (Ptr<LoraInterferenceHelper::Event> event,
+                                     const std::vector<double> &cumulativeInterferenceEnergy);
+
+  /**
+   * Determine the outcome of several events at once.
+   *
+   * This is equivalent to calling IsDestroyedByInterference on each event,
+   * but the interference energies of all events are gathered first and then
+   * scored together. It is meant for devices that finish receiving several
+   * packets at the same time, like gateways.
+   *
+   * \param events The events for which to check the outcome.
+   * \param outcomes The vector where the outcome of each event is stored, in
+   * the same order as events.
+   */
+  void IsDestroyedByInterference (const std::vector<Ptr<LoraInterferenceHelper::Event>> &events,
+                                  std::vector<uint8_t> &outcomes);
+
+  /**
+   * Determine the outcome of several events at once, given the interference
+   * energy that overlapped with each of them.
+   *
+   * \param events The events for which to check the outcome.
+   * \param cumulativeInterferenceEnergy The energy [J] of the interference
+   * overlapping with each event, for each SF from 7 to 12. The energies of
+   * event i are stored at positions 6 * i to 6 * i + 5.
+   * \param outcomes The vector where the outcome of each event is stored, in
+   * the same order as events.
+   */
+  void IsDestroyedByInterference (const std::vector<Ptr<LoraInterferenceHelper::Event>> &events,
+                                  const std::vector<double> &cumulativeInterferenceEnergy,
+                                  std::vector<uint8_t> &outcomes);
+
   /**
    * Compute the time duration in which two given events are overlapping.
    *
@@ -183,8 +330,8 @@ public:
    *
    * \return The overlap time
    */
-  Time GetOverlapTime (Ptr<LoraInterferenceHelper::Event> event1,
-                       Ptr<LoraInterferenceHelper::Event> event2);
+  Time GetOverlapTime (const Ptr<LoraInterferenceHelper::Event> &event1,
+                       const Ptr<LoraInterferenceHelper::Event> &event2);
 
   /**
    * Delete all events in the LoraInterferenceHelper.
@@ -193,23 +340,85 @@ public:
 
   /**
    * Delete old events in this LoraInterferenceHelper.
+   *
+   * An event is old if it ended more than oldEventThreshold ago, and it
+   * cannot overlap with any event that is still being received.
    */
   void CleanOldEvents (void);
 
   static CollisionMatrix collisionMatrix;
 
+  /**
+   * Whether the interference energy of the events passed to TrackEvent is
+   * accumulated as new events are added.
+   */
+  static bool incrementalEnergy;
+
   static std::vector<std::vector<double>> collisionSnirAloha;
   static std::vector<std::vector<double>> collisionSnirGoursaud;
 
 private:
+  /**
+   * An event the device is locked on, with the interference energy that
+   * overlapped with it so far.
+   */
+  struct LockedEvent
+  {
+    Ptr<LoraInterferenceHelper::Event> event; //!< The event
+    std::vector<double> energy; //!< The interference energy [J] for SF7 to SF12
+  };
+
   void SetCollisionMatrix (enum CollisionMatrix collisionMatrix);
 
-  std::vector<std::vector<double>> m_collisionSnir;
+  /**
+   * Score the signal energy of an event against the interference energy of
+   * each SF.
+   *
+   * \param signalEnergy The energy [J] of the signal to receive.
+   * \param isolation The row of the linear collision matrix for the SF of
+   * the signal.
+   * \param energy The interference energy [J] for each SF from 7 to 12.
+   * \return The sf of the first interferers that cause the loss, or 0 if
+   * there was no loss.
+   */
+  static uint8_t Score (double signalEnergy, const double *isolation, const double *energy);
+
+  /**
+   * Sum up the energy of the stored events that overlap with an event.
+   *
+   * \param event The event to compute the interference for.
+   * \param cumulativeInterferenceEnergy The energy [J] for each SF from 7 to
+   * 12, to which the contribution of each interferer is added.
+   */
+  void GetInterferenceEnergy (Ptr<LoraInterferenceHelper::Event> event,
+                              std::vector<double> &cumulativeInterferenceEnergy);
+
+  /**
+   * The events passed to TrackEvent that did not end yet.
+   */
+  std::list<LockedEvent> m_lockedEvents;
+
+  /**
+   * The collision matrix in use, as a flat array with the row of SF7 first.
+   */
+  std::array<double, 36> m_collisionSnir;
+
+  /**
+   * The collision matrix in use, in linear units.
+   */
+  std::array<double, 36> m_collisionSnirLinear;
+
+  /**
+   * The events this LoraInterferenceHelper is keeping track of, grouped by
+   * frequency and sorted by start time.
+   */
+  std::map<double, std::deque<Ptr<LoraInterferenceHelper::Event>>> m_events;
 
   /**
-   * A list of the events this LoraInterferenceHelper is keeping track of.
+   * The duration of the longest event added since the last ClearAllEvents
+   * call, which bounds how far back an overlapping event can start.
    */
-  std::list<Ptr<LoraInterferenceHelper::Event>> m_events;
+  Time m_maxDuration;
 
   /**
    * The matrix containing information about how packets survive interference.
@@ -21,7 +21,9 @@
 #include "ns3/lora-phy.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/double.h"
 #include <algorithm>
+#include <limits>
 
 namespace ns3 {
 namespace lorawan {
@@ -80,11 +82,33 @@ LoraPhy::GetTypeId (void)
                      "sniffing all frames being transmitted",
                      MakeTraceSourceAccessor (&LoraPhy::m_phySniffTxTrace),
                      "ns3::LoraPhy::SnifferRxTracedCallback")
+    .AddTraceSource ("DroppedInterferenceEvents",
+                     "Number of incoming signals that were not stored for "
+                     "interference computations because their power was "
+                     "below the InterferenceFloor. When the channel shares "
+                     "interference, signals are counted each time they are "
+                     "skipped while evaluating a reception.",
+                     MakeTraceSourceAccessor (&LoraPhy::m_droppedInterferenceEvents),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddAttribute ("InterferenceFloor",
+                   "Received power [dBm] under which incoming signals are not "
+                   "stored for interference computations. The noise floor "
+                   "used to compute the SNR of received packets is -117 dBm: "
+                   "signals some tens of dB below it cannot change the outcome "
+                   "of a reception. The default value disables the floor.",
+                   DoubleValue (-std::numeric_limits<double>::max ()),
+                   MakeDoubleAccessor (&LoraPhy::m_interferenceFloorDbm),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
-LoraPhy::LoraPhy ()
+LoraPhy::LoraPhy () :
+  m_interferenceFloorDbm (-std::numeric_limits<double>::max ()),
+  m_listening (true),
+  m_isGateway (false),
+  m_hasAddressFilter (false),
+  m_droppedInterferenceEvents (0)
 {
 }
 
@@ -171,12 +195,82 @@ LoraPhy::GetTSym (LoraTxParameters txParams)
   return Seconds (pow (2, int (txParams.sf)) / (txParams.bandwidthHz));
 }
 
+std::vector<double> LoraPhy::onAirTimes[6 * 3 * 4 * 2 * 2 * 2];
+
 Time
 LoraPhy::GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams)
 {
 
   NS_LOG_FUNCTION (packet << txParams);
 
+  // Payload size
+  uint32_t pl = packet->GetSize ();      // Size in bytes
+  NS_LOG_DEBUG ("Packet of size " << pl << " bytes");
+
+  int32_t row = GetOnAirTimeRow (txParams);
+  if (row < 0 || pl > maxTablePayloadSize)
+    {
+      return ComputeOnAirTime (pl, txParams);
+    }
+
+  // Fill the row the first time these parameters are used
+  std::vector<double> &durations = onAirTimes[row];
+  if (durations.empty ())
+    {
+      durations.resize (maxTablePayloadSize + 1);
+      for (uint32_t size = 0; size <= maxTablePayloadSize; size++)
+        {
+          durations[size] = ComputeOnAirSeconds (size, txParams);
+        }
+    }
+
+  return Seconds (durations[pl]);
+}
+
+Time
+LoraPhy::ComputeOnAirTime (uint32_t payloadSize, LoraTxParameters txParams)
+{
+  return Seconds (ComputeOnAirSeconds (payloadSize, txParams));
+}
+
+int32_t
+LoraPhy::GetOnAirTimeRow (LoraTxParameters txParams)
+{
+  int32_t bandwidth;
+  if (txParams.bandwidthHz == 125000)
+    {
+      bandwidth = 0;
+    }
+  else if (txParams.bandwidthHz == 250000)
+    {
+      bandwidth = 1;
+    }
+  else if (txParams.bandwidthHz == 500000)
+    {
+      bandwidth = 2;
+    }
+  else
+    {
+      return -1;
+    }
+
+  if (txParams.sf < 7 || txParams.sf > 12 || txParams.codingRate < 1 ||
+      txParams.codingRate > 4 || txParams.nPreamble != 8)
+    {
+      return -1;
+    }
+
+  int32_t row = (int32_t (txParams.sf) - 7) * 3 + bandwidth;
+  row = row * 4 + int32_t (txParams.codingRate) - 1;
+  row = row * 2 + (txParams.headerDisabled ? 1 : 0);
+  row = row * 2 + (txParams.crcEnabled ? 1 : 0);
+  row = row * 2 + (txParams.lowDataRateOptimizationEnabled ? 1 : 0);
+  return row;
+}
+
+double
+LoraPhy::ComputeOnAirSeconds (uint32_t payloadSize, LoraTxParameters txParams)
+{
   // The contents of this function are based on [1].
   // [1] SX1272 LoRa modem designer's guide.
 
@@ -188,8 +282,7 @@ LoraPhy::GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams)
   double tPreamble = (double(txParams.nPreamble) + 4.25) * tSym;
 
   // Payload size
-  uint32_t pl = packet->GetSize ();      // Size in bytes
-  NS_LOG_DEBUG ("Packet of size " << pl << " bytes");
+  uint32_t pl = payloadSize;      // Size in bytes
 
   // This step is needed since the formula deals with double values.
   // de = 1 when the low data rate optimization is enabled, 0 otherwise
@@ -214,7 +307,7 @@ LoraPhy::GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams)
   NS_LOG_DEBUG ("Total time = " << tPreamble + tPayload);
 
   // Compute and return the total packet on-air time
-  return Seconds (tPreamble + tPayload);
+  return tPreamble + tPayload;
 }
 
 double LoraPhy::RxPowerToSNR (double transmissionPower)
@@ -223,6 +316,171 @@ double LoraPhy::RxPowerToSNR (double transmissionPower)
   return transmissionPower + 174 - 10 * log10 (B) - NF;
 }
 
+EventId
+LoraPhy::ScheduleEndReceive (Time duration, Ptr<Packet> packet,
+                             Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << duration << packet << event);
+
+  uint32_t context = Simulator::GetContext ();
+  if (m_device != 0)
+    {
+      context = m_device->GetNode ()->GetId ();
+    }
+
+  if (context == Simulator::GetContext ())
+    {
+      return Simulator::Schedule (duration, &LoraPhy::EndReceive, this,
+                                  packet, event);
+    }
+
+  // Keep the event cancellable, and only switch context when it expires
+  return Simulator::Schedule (duration, &LoraPhy::EndReceiveWithContext, this,
+                              context, packet, event);
+}
+
+void
+LoraPhy::EndReceiveWithContext (uint32_t context, Ptr<Packet> packet,
+                                Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << context << packet << event);
+
+  Simulator::ScheduleWithContext (context, Seconds (0), &LoraPhy::EndReceive,
+                                  this, packet, event);
+}
+
+Ptr<LoraInterferenceHelper::Event>
+LoraPhy::AddInterferenceEvent (Time duration, double rxPowerDbm, uint8_t sf,
+                               Ptr<Packet> packet, double frequencyMHz)
+{
+  NS_LOG_FUNCTION (this << duration << rxPowerDbm << unsigned (sf) << packet <<
+                   frequencyMHz);
+
+  // The channel already keeps track of this transmission, and applies the
+  // floor when it evaluates interference
+  if (m_channel != 0 && m_channel->IsInterferenceShared ())
+    {
+      return Create<LoraInterferenceHelper::Event> (duration, rxPowerDbm, sf,
+                                                    packet, frequencyMHz);
+    }
+  // The signal is too weak to matter
+  if (DropsInterference (rxPowerDbm))
+    {
+      NS_LOG_DEBUG ("Not storing signal below the interference floor");
+      return Create<LoraInterferenceHelper::Event> (duration, rxPowerDbm, sf,
+                                                    packet, frequencyMHz);
+    }
+
+  return m_interference.Add (duration, rxPowerDbm, sf, packet, frequencyMHz);
+}
+
+void
+LoraPhy::LockOnInterferenceEvent (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  // Events in the channel's shared record are evaluated when they end
+  if (m_channel == 0 || !m_channel->IsInterferenceShared ())
+    {
+      m_interference.TrackEvent (event);
+    }
+}
+
+bool
+LoraPhy::DropsInterference (double rxPowerDbm)
+{
+  if (rxPowerDbm < m_interferenceFloorDbm)
+    {
+      m_droppedInterferenceEvents++;
+      return true;
+    }
+  return false;
+}
+
+bool
+LoraPhy::IsListening (void) const
+{
+  return m_listening;
+}
+
+bool
+LoraPhy::IsGateway (void) const
+{
+  return m_isGateway;
+}
+
+void
+LoraPhy::SetAddressFilter (LoraDeviceAddress address)
+{
+  NS_LOG_FUNCTION (this << address);
+
+  m_hasAddressFilter = true;
+  m_filterAddress = address;
+}
+
+bool
+LoraPhy::HasAddressFilter (void) const
+{
+  return m_hasAddressFilter;
+}
+
+bool
+LoraPhy::AcceptsAddress (LoraDeviceAddress address) const
+{
+  return !m_hasAddressFilter || address == m_filterAddress
+         || address.IsBroadcast ();
+}
+
+void
+LoraPhy::ReceiveInterference (Ptr<Packet> packet, double rxPowerDbm, uint8_t sf,
+                              Time duration, double frequencyMHz)
+{
+  NS_LOG_FUNCTION (this << packet << rxPowerDbm << unsigned (sf) << duration <<
+                   frequencyMHz);
+
+  AddInterferenceEvent (duration, rxPowerDbm, sf, packet, frequencyMHz);
+}
+
+uint8_t
+LoraPhy::IsDestroyedByInterference (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  if (m_channel != 0 && m_channel->IsInterferenceShared ())
+    {
+      std::vector<double> cumulativeInterferenceEnergy (6, 0);
+      m_channel->GetInterferenceEnergy (this, event, cumulativeInterferenceEnergy);
+      return m_interference.IsDestroyedByInterference (event,
+                                                       cumulativeInterferenceEnergy);
+    }
+
+  return m_interference.IsDestroyedByInterference (event);
+}
+
+void
+LoraPhy::IsDestroyedByInterference (const std::vector<Ptr<LoraInterferenceHelper::Event>> &events,
+                                    std::vector<uint8_t> &outcomes)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+
+  if (m_channel != 0 && m_channel->IsInterferenceShared ())
+    {
+      std::vector<double> cumulativeInterferenceEnergy (6 * events.size (), 0);
+      std::vector<double> energy (6);
+      for (std::size_t i = 0; i < events.size (); i++)
+        {
+          std::fill (energy.begin (), energy.end (), 0);
+          m_channel->GetInterferenceEnergy (this, events[i], energy);
+          std::copy (energy.begin (), energy.end (),
+                     cumulativeInterferenceEnergy.begin () + 6 * i);
+        }
+      m_interference.IsDestroyedByInterference (events, cumulativeInterferenceEnergy, outcomes);
+      return;
+    }
+
+  m_interference.IsDestroyedByInterference (events, outcomes);
+}
+
 std::ostream &operator << (std::ostream &os, const LoraTxParameters &params)
 {
   os << "SF: " << unsigned(params.sf) <<
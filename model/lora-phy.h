@@ -25,12 +25,16 @@
 #include "ns3/callback.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-value.h"
 #include "ns3/mobility-model.h"
 #include "ns3/node.h"
 #include "ns3/lora-channel.h"
 #include "ns3/net-device.h"
 #include "ns3/lora-interference-helper.h"
+#include "ns3/lora-device-address.h"
 #include <list>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
@@ -120,6 +124,22 @@ public:
                              uint8_t sf, Time duration,
                              double frequencyMHz) = 0;
 
+  /**
+   * Register an arriving packet as interference, without trying to receive
+   * it.
+   *
+   * This method is called by LoraChannel instead of StartReceive for packets
+   * this PHY never needs to decode.
+   *
+   * \param packet The packet that is arriving at this PHY layer.
+   * \param rxPowerDbm The power of the arriving packet.
+   * \param sf The Spreading Factor of the arriving packet.
+   * \param duration The on air time of this packet.
+   * \param frequencyMHz The frequency this packet is being transmitted on.
+   */
+  void ReceiveInterference (Ptr<Packet> packet, double rxPowerDbm, uint8_t sf,
+                            Time duration, double frequencyMHz);
+
   /**
    * Finish reception of a packet.
    *
@@ -163,6 +183,65 @@ public:
    */
   virtual bool IsOnFrequency (double frequency) = 0;
 
+  /**
+   * Get the best-case sensitivity of this PHY.
+   *
+   * \returns The lowest receive power [dBm] this device is able to lock on,
+   * across all Spreading Factors.
+   */
+  virtual double GetMinSensitivity (void) const = 0;
+
+  /**
+   * Check whether a signal is too weak to be considered as interference by
+   * this PHY, counting it in the DroppedInterferenceEvents trace source if it
+   * is.
+   *
+   * \param rxPowerDbm The power of the signal.
+   * \returns true if the power is below the InterferenceFloor.
+   */
+  bool DropsInterference (double rxPowerDbm);
+
+  /**
+   * Whether this device can currently start receiving a packet.
+   *
+   * Channels with the LazyReception attribute set only notify listening
+   * devices of transmissions.
+   *
+   * \returns true if the device can lock on a packet, false otherwise.
+   */
+  bool IsListening (void) const;
+
+  /**
+   * Whether this is the PHY of a gateway.
+   *
+   * \returns true for gateway PHYs, false for end device PHYs.
+   */
+  bool IsGateway (void) const;
+
+  /**
+   * Only lock on downlinks addressed to a device, or broadcast.
+   *
+   * Channels with the AddressFiltering attribute set deliver other downlinks
+   * to this PHY as interference only.
+   *
+   * \param address The address of the device this PHY belongs to.
+   */
+  void SetAddressFilter (LoraDeviceAddress address);
+
+  /**
+   * Whether this PHY only locks on downlinks for a specific address.
+   */
+  bool HasAddressFilter (void) const;
+
+  /**
+   * Whether this PHY wants to lock on a downlink.
+   *
+   * \param address The destination address of the downlink.
+   * \return true if there is no address filter, or if the address is the
+   * filtered one or the broadcast address.
+   */
+  bool AcceptsAddress (LoraDeviceAddress address) const;
+
   /**
    * Set the callback to call upon successful reception of a packet.
    *
@@ -248,13 +327,68 @@ public:
    * (obtained through a GetSize () call to accout for the presence of Headers
    * and Trailers, too) also influences the packet transmit time.
    *
+   * For the standard bandwidths, coding rates and preamble length, the time
+   * is looked up in a table that is filled the first time a set of
+   * parameters is used.
+   *
    * \param packet The packet that needs to be transmitted.
    * \param txParams The set of parameters that will be used for transmission.
    * \return The time necessary to transmit the packet.
    */
   static Time GetOnAirTime (Ptr<Packet> packet, LoraTxParameters txParams);
 
+  /**
+   * Compute the time on air of a packet using the formula of the SX1272
+   * LoRa modem designer's guide, without looking it up in the table.
+   *
+   * \param payloadSize The size of the packet [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the packet.
+   */
+  static Time ComputeOnAirTime (uint32_t payloadSize, LoraTxParameters txParams);
+
 private:
+  /**
+   * Compute the time on air of a packet, in seconds.
+   *
+   * \param payloadSize The size of the packet [bytes].
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The time necessary to transmit the packet [s].
+   */
+  static double ComputeOnAirSeconds (uint32_t payloadSize, LoraTxParameters txParams);
+
+  /**
+   * Get the row of onAirTimes holding the time on air for a set of
+   * transmission parameters.
+   *
+   * \param txParams The set of parameters that will be used for transmission.
+   * \return The index of the row, or -1 if the times on air for these
+   * parameters are not stored.
+   */
+  static int32_t GetOnAirTimeRow (LoraTxParameters txParams);
+
+  /**
+   * The largest payload size [bytes] whose time on air is stored.
+   */
+  static const uint32_t maxTablePayloadSize = 255;
+
+  /**
+   * The times on air [s] for each set of stored transmission parameters, and
+   * each payload size up to maxTablePayloadSize. Rows are empty until the
+   * corresponding parameters are first used.
+   */
+  static std::vector<double> onAirTimes[6 * 3 * 4 * 2 * 2 * 2];
+
+  /**
+   * Call EndReceive in the context of a different node.
+   *
+   * \param context The context to switch to.
+   * \param packet The packet being received.
+   * \param event The interference event of the packet.
+   */
+  void EndReceiveWithContext (uint32_t context, Ptr<Packet> packet,
+                              Ptr<LoraInterferenceHelper::Event> event);
+
   Ptr<MobilityModel> m_mobility;   //!< The mobility model associated to this PHY.
 
 protected:
@@ -268,6 +402,69 @@ protected:
    */
   double RxPowerToSNR (double transmissionPower);
 
+  /**
+   * Schedule the EndReceive call for a packet this PHY locked on.
+   *
+   * The EndReceive call always happens in the context of the node this PHY
+   * belongs to, even if the channel started the reception from a different
+   * context (as it does with batched delivery).
+   *
+   * \param duration The time after which the reception ends.
+   * \param packet The packet being received.
+   * \param event The interference event of the packet.
+   * \return The id of the scheduled event, that can be used to cancel it.
+   */
+  EventId ScheduleEndReceive (Time duration, Ptr<Packet> packet,
+                              Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Create the interference event for an incoming signal.
+   *
+   * The event is stored in m_interference, unless the channel keeps a shared
+   * record of transmissions.
+   *
+   * \param duration The duration of the signal.
+   * \param rxPowerDbm The power of the signal.
+   * \param sf The spreading factor of the signal.
+   * \param packet The packet carried by the signal.
+   * \param frequencyMHz The frequency of the signal.
+   * \return The event.
+   */
+  Ptr<LoraInterferenceHelper::Event> AddInterferenceEvent (Time duration,
+                                                           double rxPowerDbm,
+                                                           uint8_t sf,
+                                                           Ptr<Packet> packet,
+                                                           double frequencyMHz);
+
+  /**
+   * Notify the interference helper that this PHY locked on an event.
+   *
+   * \param event The event this PHY is now receiving.
+   */
+  void LockOnInterferenceEvent (Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Determine whether an event was destroyed by interference, using either
+   * m_interference or the shared record of transmissions of the channel.
+   *
+   * \param event The event for which to check the outcome.
+   * \return The sf of the packets that caused the loss, or 0 if there was no
+   * loss.
+   */
+  uint8_t IsDestroyedByInterference (Ptr<LoraInterferenceHelper::Event> event);
+
+  /**
+   * Determine the outcome of several events that end at the same time, using
+   * either m_interference or the shared record of transmissions of the
+   * channel.
+   *
+   * \param events The events for which to check the outcome.
+   * \param outcomes The vector where the outcome of each event is stored, in
+   * the same order as events.
+   */
+  void IsDestroyedByInterference (const std::vector<Ptr<LoraInterferenceHelper::Event>> &events,
+                                  std::vector<uint8_t> &outcomes);
+
   // Member objects
 
   Ptr<NetDevice> m_device; //!< The net device this PHY is attached to.
@@ -277,6 +474,17 @@ protected:
   LoraInterferenceHelper m_interference; //!< The LoraInterferenceHelper
   //!associated to this PHY.
 
+  double m_interferenceFloorDbm; //!< The power under which signals are not
+  //!stored in m_interference.
+
+  bool m_listening; //!< Whether this device can start receiving a packet.
+
+  bool m_isGateway; //!< Whether this is the PHY of a gateway.
+
+  bool m_hasAddressFilter; //!< Whether downlinks are filtered by address.
+
+  LoraDeviceAddress m_filterAddress; //!< The address of accepted downlinks.
+
   // Constants
 
   const int B = 125000; //!Bandwidth (Hz)
@@ -344,6 +552,12 @@ protected:
    */
   TracedCallback<Ptr<const Packet> > m_phySniffTxTrace;
 
+  /**
+   * The number of incoming signals that were not stored in m_interference
+   * because they were below the interference floor.
+   */
+  TracedValue<uint32_t> m_droppedInterferenceEvents;
+
   // Callbacks
 
   /**
@@ -50,7 +50,9 @@ LoraTag::LoraTag (uint8_t sf, uint8_t destroyedBy) :
   m_receivePower (0),
   m_dataRate (0),
   m_frequency (0),
-  m_snr (0)
+  m_snr (0),
+  m_hasDestination (false),
+  m_destination (0)
 {
 }
 
@@ -62,8 +64,9 @@ uint32_t
 LoraTag::GetSerializedSize (void) const
 {
   // Each datum about a SF is 1 byte + receivePower (the size of a double) +
-  // frequency (the size of a double) + SNR (the size of a double)
-  return 3 + 3 * sizeof(double);
+  // frequency (the size of a double) + SNR (the size of a double) +
+  // destination (1 byte flag and 4 bytes address)
+  return 3 + 3 * sizeof(double) + 5;
 }
 
 void
@@ -75,6 +78,8 @@ LoraTag::Serialize (TagBuffer i) const
   i.WriteU8 (m_dataRate);
   i.WriteDouble (m_frequency);
   i.WriteDouble (m_snr);
+  i.WriteU8 (m_hasDestination);
+  i.WriteU32 (m_destination);
 }
 
 void
@@ -86,6 +91,8 @@ LoraTag::Deserialize (TagBuffer i)
   m_dataRate = i.ReadU8 ();
   m_frequency = i.ReadDouble ();
   m_snr = i.ReadDouble ();
+  m_hasDestination = i.ReadU8 ();
+  m_destination = i.ReadU32 ();
 }
 
 void
@@ -138,13 +145,13 @@ LoraTag::SetFrequency (double frequency)
 }
 
 double
-LoraTag::GetFrequency (void)
+LoraTag::GetFrequency (void) const
 {
   return m_frequency;
 }
 
 uint8_t
-LoraTag::GetDataRate (void)
+LoraTag::GetDataRate (void) const
 {
   return m_dataRate;
 }
@@ -167,5 +174,24 @@ LoraTag::SetSnr (double snr)
   m_snr = snr;
 }
 
+void
+LoraTag::SetDestination (LoraDeviceAddress destination)
+{
+  m_hasDestination = true;
+  m_destination = destination.Get ();
+}
+
+bool
+LoraTag::HasDestination (void) const
+{
+  return m_hasDestination;
+}
+
+LoraDeviceAddress
+LoraTag::GetDestination (void) const
+{
+  return LoraDeviceAddress (m_destination);
+}
+
 }
 } // namespace ns3
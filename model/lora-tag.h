@@ -22,6 +22,7 @@
 #define LORA_TAG_H
 
 #include "ns3/tag.h"
+#include "ns3/lora-device-address.h"
 
 namespace ns3 {
 namespace lorawan {
@@ -107,14 +108,14 @@ public:
   /**
    * Get the frequency of the packet.
    */
-  double GetFrequency (void);
+  double GetFrequency (void) const;
 
   /**
    * Get the data rate for this packet.
    *
    * \return The data rate that needs to be employed for this packet.
    */
-  uint8_t GetDataRate (void);
+  uint8_t GetDataRate (void) const;
 
   /**
    * Set the data rate for this packet.
@@ -137,6 +138,29 @@ public:
    */
   void SetSnr (double snr);
 
+  /**
+   * Set the device a downlink is meant for.
+   *
+   * Channels with the AddressFiltering attribute set use this address to
+   * decide which PHYs lock on the downlink.
+   *
+   * \param destination The address of the device, or
+   * LoraDeviceAddress::GetBroadcast () for downlinks meant for all devices.
+   */
+  void SetDestination (LoraDeviceAddress destination);
+
+  /**
+   * Whether the destination of this packet was set.
+   */
+  bool HasDestination (void) const;
+
+  /**
+   * Get the device a downlink is meant for.
+   *
+   * \return The destination, only meaningful if HasDestination () is true.
+   */
+  LoraDeviceAddress GetDestination (void) const;
+
 private:
   uint8_t m_sf; //!< The Spreading Factor used by the packet.
   uint8_t m_destroyedBy; //!< The Spreading Factor that destroyed the packet.
@@ -145,6 +169,8 @@ private:
   //!packet.
   double m_frequency; //!< The frequency of this packet
   double m_snr; //!< The SNR of this packet during demodulation
+  bool m_hasDestination; //!< Whether m_destination was set
+  uint32_t m_destination; //!< The device this downlink is meant for
 };
 } // namespace ns3
 }
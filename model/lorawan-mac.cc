@@ -52,7 +52,8 @@ LorawanMac::GetTypeId (void)
   return tid;
 }
 
-LorawanMac::LorawanMac ()
+LorawanMac::LorawanMac () :
+  m_regionProfile (Create<RegionProfile> ())
 {
   NS_LOG_FUNCTION (this);
 }
@@ -109,13 +110,15 @@ LorawanMac::GetSfFromDataRate (uint8_t dataRate)
 {
   NS_LOG_FUNCTION (this << unsigned(dataRate));
 
+  const std::vector<uint8_t> &sfForDataRate = m_regionProfile->GetSfForDataRate ();
+
   // Check we are in range
-  if (dataRate >= m_sfForDataRate.size ())
+  if (dataRate >= sfForDataRate.size ())
     {
       return 0;
     }
 
-  return m_sfForDataRate.at (dataRate);
+  return sfForDataRate.at (dataRate);
 }
 
 double
@@ -123,13 +126,15 @@ LorawanMac::GetBandwidthFromDataRate (uint8_t dataRate)
 {
   NS_LOG_FUNCTION (this << unsigned(dataRate));
 
+  const std::vector<double> &bandwidthForDataRate = m_regionProfile->GetBandwidthForDataRate ();
+
   // Check we are in range
-  if (dataRate > m_bandwidthForDataRate.size ())
+  if (dataRate > bandwidthForDataRate.size ())
     {
       return 0;
     }
 
-  return m_bandwidthForDataRate.at (dataRate);
+  return bandwidthForDataRate.at (dataRate);
 }
 
 double
@@ -137,36 +142,64 @@ LorawanMac::GetDbmForTxPower (uint8_t txPower)
 {
   NS_LOG_FUNCTION (this << unsigned (txPower));
 
-  if (txPower > m_txDbmForTxPower.size ())
+  const std::vector<double> &txDbmForTxPower = m_regionProfile->GetTxDbmForTxPower ();
+
+  if (txPower > txDbmForTxPower.size ())
     {
       return 0;
     }
 
-  return m_txDbmForTxPower.at (txPower);
+  return txDbmForTxPower.at (txPower);
+}
+
+void
+LorawanMac::SetRegionProfile (Ptr<const RegionProfile> regionProfile)
+{
+  m_regionProfile = regionProfile;
+}
+
+Ptr<const RegionProfile>
+LorawanMac::GetRegionProfile (void) const
+{
+  return m_regionProfile;
+}
+
+Ptr<RegionProfile>
+LorawanMac::CopyRegionProfile (void) const
+{
+  return Create<RegionProfile> (*m_regionProfile);
 }
 
 void
 LorawanMac::SetSfForDataRate (std::vector<uint8_t> sfForDataRate)
 {
-  m_sfForDataRate = sfForDataRate;
+  Ptr<RegionProfile> regionProfile = CopyRegionProfile ();
+  regionProfile->SetSfForDataRate (sfForDataRate);
+  m_regionProfile = regionProfile;
 }
 
 void
 LorawanMac::SetBandwidthForDataRate (std::vector<double> bandwidthForDataRate)
 {
-  m_bandwidthForDataRate = bandwidthForDataRate;
+  Ptr<RegionProfile> regionProfile = CopyRegionProfile ();
+  regionProfile->SetBandwidthForDataRate (bandwidthForDataRate);
+  m_regionProfile = regionProfile;
 }
 
 void
 LorawanMac::SetMaxAppPayloadForDataRate (std::vector<uint32_t> maxAppPayloadForDataRate)
 {
-  m_maxAppPayloadForDataRate = maxAppPayloadForDataRate;
+  Ptr<RegionProfile> regionProfile = CopyRegionProfile ();
+  regionProfile->SetMaxAppPayloadForDataRate (maxAppPayloadForDataRate);
+  m_regionProfile = regionProfile;
 }
 
 void
 LorawanMac::SetTxDbmForTxPower (std::vector<double> txDbmForTxPower)
 {
-  m_txDbmForTxPower = txDbmForTxPower;
+  Ptr<RegionProfile> regionProfile = CopyRegionProfile ();
+  regionProfile->SetTxDbmForTxPower (txDbmForTxPower);
+  m_regionProfile = regionProfile;
 }
 
 void
@@ -184,7 +217,9 @@ LorawanMac::GetNPreambleSymbols (void)
 void
 LorawanMac::SetReplyDataRateMatrix (ReplyDataRateMatrix replyDataRateMatrix)
 {
-  m_replyDataRateMatrix = replyDataRateMatrix;
+  Ptr<RegionProfile> regionProfile = CopyRegionProfile ();
+  regionProfile->SetReplyDataRateMatrix (replyDataRateMatrix);
+  m_regionProfile = regionProfile;
 }
 }
 }
@@ -25,6 +25,7 @@
 #include "ns3/logical-lora-channel-helper.h"
 #include "ns3/packet.h"
 #include "ns3/lora-phy.h"
+#include "ns3/region-profile.h"
 #include <array>
 
 namespace ns3 {
@@ -47,7 +48,7 @@ public:
   LorawanMac ();
   virtual ~LorawanMac ();
 
-  typedef std::array<std::array<uint8_t, 6>, 8> ReplyDataRateMatrix;
+  typedef RegionProfile::ReplyDataRateMatrix ReplyDataRateMatrix;
 
   /**
    * Set the underlying PHY layer
@@ -120,6 +121,23 @@ public:
    */
   void SetLogicalLoraChannelHelper (LogicalLoraChannelHelper helper);
 
+  /**
+   * Set the regional parameters this MAC instance will use.
+   *
+   * The profile is shared with the other MAC layers using it. The setters of
+   * the single parameters make this MAC switch to a copy of it.
+   *
+   * \param regionProfile The profile to use.
+   */
+  void SetRegionProfile (Ptr<const RegionProfile> regionProfile);
+
+  /**
+   * Get the regional parameters this MAC instance is using.
+   *
+   * \return The profile in use.
+   */
+  Ptr<const RegionProfile> GetRegionProfile (void) const;
+
   /**
    * Get the SF corresponding to a data rate, based on this MAC's region.
    *
@@ -246,36 +264,24 @@ protected:
   LogicalLoraChannelHelper m_channelHelper;
 
   /**
-   * A vector holding the SF each Data Rate corresponds to.
+   * The regional parameters: the SF, bandwidth and maximum app payload size
+   * each Data Rate corresponds to, the power that corresponds to a certain
+   * TxPower value and the matrix that decides the DR the GW will use in a
+   * reply based on the ED's sending DR and on the value of the RX1DROffset
+   * parameter.
    */
-  std::vector<uint8_t> m_sfForDataRate;
-
-  /**
-   * A vector holding the bandwidth each Data Rate corresponds to.
-   */
-  std::vector<double> m_bandwidthForDataRate;
-
-  /**
-   * A vector holding the maximum app payload size that corresponds to a
-   * certain DataRate.
-   */
-  std::vector<uint32_t> m_maxAppPayloadForDataRate;
+  Ptr<const RegionProfile> m_regionProfile;
 
   /**
    * The number of symbols to use in the PHY preamble.
    */
   int m_nPreambleSymbols;
 
+private:
   /**
-   * A vector holding the power that corresponds to a certain TxPower value.
-   */
-  std::vector<double> m_txDbmForTxPower;
-
-  /**
-   * The matrix that decides the DR the GW will use in a reply based on the ED's
-   * sending DR and on the value of the RX1DROffset parameter.
+   * Get a copy of m_regionProfile this MAC can modify.
    */
-  ReplyDataRateMatrix m_replyDataRateMatrix;
+  Ptr<RegionProfile> CopyRegionProfile (void) const;
 };
 
 } /* namespace ns3 */
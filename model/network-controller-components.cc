@@ -66,19 +66,15 @@ ConfirmedMessagesComponent::~ConfirmedMessagesComponent ()
 }
 
 void
-ConfirmedMessagesComponent::OnReceivedPacket (Ptr<const Packet> packet,
+ConfirmedMessagesComponent::OnReceivedPacket (Ptr<const UplinkContext> context,
                                               Ptr<EndDeviceStatus> status,
                                               Ptr<NetworkStatus> networkStatus)
 {
-  NS_LOG_FUNCTION (this->GetTypeId () << packet << networkStatus);
+  NS_LOG_FUNCTION (this->GetTypeId () << context->GetPacket () << networkStatus);
 
   // Check whether the received packet requires an acknowledgment.
-  LorawanMacHeader mHdr;
-  LoraFrameHeader fHdr;
-  fHdr.SetAsUplink ();
-  Ptr<Packet> myPacket = packet->Copy ();
-  myPacket->RemoveHeader (mHdr);
-  myPacket->RemoveHeader (fHdr);
+  const LorawanMacHeader &mHdr = context->GetMacHeader ();
+  const LoraFrameHeader &fHdr = context->GetFrameHeader ();
 
   NS_LOG_INFO ("Received packet Mac Header: " << mHdr);
   NS_LOG_INFO ("Received packet Frame Header: " << fHdr);
@@ -143,11 +139,11 @@ LinkCheckComponent::~LinkCheckComponent ()
 }
 
 void
-LinkCheckComponent::OnReceivedPacket (Ptr<const Packet> packet,
+LinkCheckComponent::OnReceivedPacket (Ptr<const UplinkContext> context,
                                       Ptr<EndDeviceStatus> status,
                                       Ptr<NetworkStatus> networkStatus)
 {
-  NS_LOG_FUNCTION (this->GetTypeId () << packet << networkStatus);
+  NS_LOG_FUNCTION (this->GetTypeId () << context->GetPacket () << networkStatus);
 
   // We will only act just before reply, when all Gateways will have received
   // the packet.
@@ -159,12 +155,7 @@ LinkCheckComponent::BeforeSendingReply (Ptr<EndDeviceStatus> status,
 {
   NS_LOG_FUNCTION (this << status << networkStatus);
 
-  Ptr<Packet> myPacket = status->GetLastPacketReceivedFromDevice ()->Copy ();
-  LorawanMacHeader mHdr;
-  LoraFrameHeader fHdr;
-  fHdr.SetAsUplink ();
-  myPacket->RemoveHeader (mHdr);
-  myPacket->RemoveHeader (fHdr);
+  const LoraFrameHeader &fHdr = status->GetLastFrameHeader ();
 
   Ptr<LinkCheckReq> command = fHdr.GetMacCommand<LinkCheckReq> ();
 
@@ -55,10 +55,10 @@ public:
   /**
    * Method that is called when a new packet is received by the NetworkServer.
    *
-   * \param packet The newly received packet
+   * \param context The newly received uplink
    * \param networkStatus A pointer to the NetworkStatus object
    */
-  virtual void OnReceivedPacket (Ptr<const Packet> packet,
+  virtual void OnReceivedPacket (Ptr<const UplinkContext> context,
                                  Ptr<EndDeviceStatus> status,
                                  Ptr<NetworkStatus> networkStatus) = 0;
 
@@ -93,10 +93,10 @@ public:
    * This method checks whether the received packet requires an acknowledgment
    * and sets up the appropriate reply in case it does.
    *
-   * \param packet The newly received packet
+   * \param context The newly received uplink
    * \param networkStatus A pointer to the NetworkStatus object
    */
-  void OnReceivedPacket (Ptr<const Packet> packet,
+  void OnReceivedPacket (Ptr<const UplinkContext> context,
                          Ptr<EndDeviceStatus> status,
                          Ptr<NetworkStatus> networkStatus);
 
@@ -124,10 +124,10 @@ public:
    * This method checks whether the received packet requires an acknowledgment
    * and sets up the appropriate reply in case it does.
    *
-   * \param packet The newly received packet
+   * \param context The newly received uplink
    * \param networkStatus A pointer to the NetworkStatus object
    */
-  void OnReceivedPacket (Ptr<const Packet> packet,
+  void OnReceivedPacket (Ptr<const UplinkContext> context,
                          Ptr<EndDeviceStatus> status,
                          Ptr<NetworkStatus> networkStatus);
 
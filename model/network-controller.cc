@@ -60,9 +60,9 @@ NetworkController::Install (Ptr<NetworkControllerComponent> component)
 }
 
 void
-NetworkController::OnNewPacket (Ptr<Packet const> packet)
+NetworkController::OnNewPacket (Ptr<const UplinkContext> context)
 {
-  NS_LOG_FUNCTION (this << packet);
+  NS_LOG_FUNCTION (this << context->GetPacket ());
 
   // NOTE As a future optimization, we can allow components to register their
   // callbacks and only be called in case a certain MAC command is contained.
@@ -71,8 +71,8 @@ NetworkController::OnNewPacket (Ptr<Packet const> packet)
   // Inform each component about the new packet
   for (auto it = m_components.begin (); it != m_components.end (); ++it)
     {
-      (*it)->OnReceivedPacket (packet,
-                               m_status->GetEndDeviceStatus (packet),
+      (*it)->OnReceivedPacket (context,
+                               context->GetEndDeviceStatus (),
                                m_status);
     }
 }
@@ -54,9 +54,9 @@ public:
   /**
    * Method that is called by the NetworkServer when a new packet is received.
    *
-   * \param packet The newly received packet.
+   * \param context The newly received uplink.
    */
-  void OnNewPacket (Ptr<Packet const> packet);
+  void OnNewPacket (Ptr<const UplinkContext> context);
 
   /**
    * Method that is called by the NetworkScheduler just before sending a reply
@@ -37,37 +37,30 @@ NetworkScheduler::~NetworkScheduler ()
 }
 
 void
-NetworkScheduler::OnReceivedPacket (Ptr<const Packet> packet)
+NetworkScheduler::OnReceivedPacket (Ptr<const UplinkContext> context)
 {
-  NS_LOG_FUNCTION (packet);
+  NS_LOG_FUNCTION (context->GetPacket ());
 
-  // Get the current packet's frame counter
-  Ptr<Packet> packetCopy = packet->Copy ();
-  LorawanMacHeader receivedMacHdr;
-  packetCopy->RemoveHeader (receivedMacHdr);
-  LoraFrameHeader receivedFrameHdr;
-  receivedFrameHdr.SetAsUplink ();
-  packetCopy->RemoveHeader (receivedFrameHdr);
+  Ptr<EndDeviceStatus> edStatus = context->GetEndDeviceStatus ();
 
   // Need to decide whether to schedule a receive window
-  if (!m_status->GetEndDeviceStatus (packet)->HasReceiveWindowOpportunityScheduled ())
+  if (!edStatus->HasReceiveWindowOpportunityScheduled ())
   {
-    // Extract the address
-    LoraDeviceAddress deviceAddress = receivedFrameHdr.GetAddress ();
-
     // Schedule OnReceiveWindowOpportunity event
-    m_status->GetEndDeviceStatus (packet)->SetReceiveWindowOpportunity (
+    edStatus->SetReceiveWindowOpportunity (
       Simulator::Schedule (Seconds (1),
                            &NetworkScheduler::OnReceiveWindowOpportunity,
                            this,
-                           deviceAddress,
+                           edStatus,
                            1)); // This will be the first receive window
   }
 }
 
 void
-NetworkScheduler::OnReceiveWindowOpportunity (LoraDeviceAddress deviceAddress, int window)
+NetworkScheduler::OnReceiveWindowOpportunity (Ptr<EndDeviceStatus> edStatus, int window)
 {
+  LoraDeviceAddress deviceAddress = edStatus->GetEndDeviceAddress ();
+
   NS_LOG_FUNCTION (deviceAddress);
 
   NS_LOG_DEBUG ("Opening receive window number " << window << " for device "
@@ -75,23 +68,23 @@ NetworkScheduler::OnReceiveWindowOpportunity (LoraDeviceAddress deviceAddress, i
 
   // Check whether we can send a reply to the device, again by using
   // NetworkStatus
-  Address gwAddress = m_status->GetBestGatewayForDevice (deviceAddress, window);
+  Ptr<GatewayStatus> gwStatus = m_status->GetBestGatewayForDevice (edStatus, window);
 
-  if (gwAddress == Address () && window == 1)
+  if (gwStatus == 0 && window == 1)
     {
       NS_LOG_DEBUG ("No suitable gateway found for first window.");
 
       // No suitable GW was found, but there's still hope to find one for the
       // second window.
       // Schedule another OnReceiveWindowOpportunity event
-      m_status->GetEndDeviceStatus (deviceAddress)->SetReceiveWindowOpportunity (
+      edStatus->SetReceiveWindowOpportunity (
         Simulator::Schedule (Seconds (1),
                              &NetworkScheduler::OnReceiveWindowOpportunity,
                              this,
-                             deviceAddress,
+                             edStatus,
                              2));     // This will be the second receive window
     }
-  else if (gwAddress == Address () && window == 2)
+  else if (gwStatus == 0 && window == 2)
     {
       // No suitable GW was found and this was our last opportunity
       // Simply give up.
@@ -100,20 +93,19 @@ NetworkScheduler::OnReceiveWindowOpportunity (LoraDeviceAddress deviceAddress, i
 
       // Reset the reply
       // XXX Should we reset it here or keep it for the next opportunity?
-      m_status->GetEndDeviceStatus (deviceAddress)->RemoveReceiveWindowOpportunity();
-      m_status->GetEndDeviceStatus (deviceAddress)->InitializeReply ();
+      edStatus->RemoveReceiveWindowOpportunity();
+      edStatus->InitializeReply ();
     }
   else
     {
       // A gateway was found
 
-      NS_LOG_DEBUG ("Found available gateway with address: " << gwAddress);
+      NS_LOG_DEBUG ("Found available gateway with address: " << gwStatus->GetAddress ());
 
-      m_controller->BeforeSendingReply (m_status->GetEndDeviceStatus
-                                          (deviceAddress));
+      m_controller->BeforeSendingReply (edStatus);
 
-      // Check whether this device needs a response by querying m_status
-      bool needsReply = m_status->NeedsReply (deviceAddress);
+      // Check whether this device needs a response
+      bool needsReply = edStatus->NeedsReply ();
 
       if (needsReply)
         {
@@ -121,12 +113,12 @@ NetworkScheduler::OnReceiveWindowOpportunity (LoraDeviceAddress deviceAddress, i
 
           // Send the reply through that gateway
           m_status->SendThroughGateway (m_status->GetReplyForDevice
-                                          (deviceAddress, window),
-                                        gwAddress);
+                                          (edStatus, window),
+                                        gwStatus);
 
           // Reset the reply
-          m_status->GetEndDeviceStatus (deviceAddress)->RemoveReceiveWindowOpportunity();
-          m_status->GetEndDeviceStatus (deviceAddress)->InitializeReply ();
+          edStatus->RemoveReceiveWindowOpportunity();
+          edStatus->InitializeReply ();
         }
     }
 }
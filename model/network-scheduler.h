@@ -29,6 +29,7 @@
 #include "ns3/lora-frame-header.h"
 #include "ns3/network-controller.h"
 #include "ns3/network-status.h"
+#include "ns3/uplink-context.h"
 
 namespace ns3 {
 namespace lorawan {
@@ -50,14 +51,19 @@ public:
    * Method called by NetworkServer to inform the Scheduler of a newly arrived
    * uplink packet. This function schedules the OnReceiveWindowOpportunity
    * events 1 and 2 seconds later.
+   *
+   * \param context The newly arrived uplink.
    */
-  void OnReceivedPacket (Ptr<const Packet> packet);
+  void OnReceivedPacket (Ptr<const UplinkContext> context);
 
   /**
    * Method that is scheduled after packet arrivals in order to act on
    * receive windows 1 and 2 seconds later receptions.
+   *
+   * \param edStatus The status of the device that sent the packet.
+   * \param window The receive window that is opening.
    */
-  void OnReceiveWindowOpportunity (LoraDeviceAddress deviceAddress, int window);
+  void OnReceiveWindowOpportunity (Ptr<EndDeviceStatus> edStatus, int window);
 
 private:
   TracedCallback<Ptr<const Packet> > m_receiveWindowOpened;
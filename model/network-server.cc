@@ -155,20 +155,20 @@ NetworkServer::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
 {
   NS_LOG_FUNCTION (this << packet << protocol << address);
 
-  // Create a copy of the packet
-  Ptr<Packet> myPacket = packet->Copy ();
-
   // Fire the trace source
   m_receivedPacket (packet);
 
+  // Read the packet once for all the components
+  Ptr<const UplinkContext> context = Create<UplinkContext> (packet, address, m_status);
+
   // Inform the scheduler of the newly arrived packet
-  m_scheduler->OnReceivedPacket (packet);
+  m_scheduler->OnReceivedPacket (context);
 
   // Inform the status of the newly arrived packet
-  m_status->OnReceivedPacket (packet, address);
+  m_status->OnReceivedPacket (context);
 
   // Inform the controller of the newly arrived packet
-  m_controller->OnNewPacket (packet);
+  m_controller->OnNewPacket (context);
 
   return true;
 }
@@ -63,15 +63,15 @@ NetworkStatus::AddNode (Ptr<EndDeviceLorawanMac> edMac)
 
   // Check whether this device already exists in our list
   LoraDeviceAddress edAddress = edMac->GetDeviceAddress ();
-  if (m_endDeviceStatuses.find (edAddress) == m_endDeviceStatuses.end ())
+  if (m_endDeviceStatuses.find (edAddress.Get ()) == m_endDeviceStatuses.end ())
     {
       // The device doesn't exist. Create new EndDeviceStatus
       Ptr<EndDeviceStatus> edStatus = CreateObject<EndDeviceStatus>
         (edAddress, edMac->GetObject<EndDeviceLorawanMac>());
 
-      // Add it to the map
-      m_endDeviceStatuses.insert (std::pair<LoraDeviceAddress, Ptr<EndDeviceStatus> >
-                                  (edAddress, edStatus));
+      // Add it to the registry
+      m_endDeviceStatuses.insert (std::pair<uint32_t, Ptr<EndDeviceStatus> >
+                                  (edAddress.Get (), edStatus));
       NS_LOG_DEBUG ("Added to the list a device with address " <<
                     edAddress.Print ());
     }
@@ -83,51 +83,52 @@ NetworkStatus::AddGateway (Address& address, Ptr<GatewayStatus> gwStatus)
   NS_LOG_FUNCTION (this);
 
   // Check whether this device already exists in the list
-  if (m_gatewayStatuses.find (address) == m_gatewayStatuses.end ())
+  if (m_gatewayIndices.find (address) == m_gatewayIndices.end ())
     {
       // The device doesn't exist.
 
-      // Add it to the map
-      m_gatewayStatuses.insert (std::pair<Address, Ptr<GatewayStatus> >
-                                (address, gwStatus));
+      // Add it to the registry
+      m_gatewayIndices.insert (std::pair<Address, uint32_t>
+                               (address, m_gatewayStatuses.size ()));
+      m_gatewayStatuses.push_back (gwStatus);
       NS_LOG_DEBUG ("Added to the list a gateway with address " << address);
     }
 }
 
 void
-NetworkStatus::OnReceivedPacket (Ptr<const Packet> packet,
-                                  const Address& gwAddress)
+NetworkStatus::OnReceivedPacket (Ptr<const UplinkContext> context)
 {
-  NS_LOG_FUNCTION (this << packet << gwAddress);
-
-  // Create a copy of the packet
-  Ptr<Packet> myPacket = packet->Copy ();
-
-  // Extract the headers
-  LorawanMacHeader macHdr;
-  myPacket->RemoveHeader (macHdr);
-  LoraFrameHeader frameHdr;
-  frameHdr.SetAsUplink ();
-  myPacket->RemoveHeader (frameHdr);
+  NS_LOG_FUNCTION (this << context->GetPacket () << context->GetGatewayAddress ());
 
   // Update the correct EndDeviceStatus object
-  LoraDeviceAddress edAddr = frameHdr.GetAddress ();
-  NS_LOG_DEBUG ("Node address: " << edAddr);
-  m_endDeviceStatuses.at (edAddr)->InsertReceivedPacket (packet, gwAddress);
+  NS_LOG_DEBUG ("Node address: " << context->GetDeviceAddress ());
+  NS_ASSERT_MSG (context->GetEndDeviceStatus (), "Uplink from an unknown device");
+  context->GetEndDeviceStatus ()->InsertReceivedPacket (context);
 }
 
 bool
 NetworkStatus::NeedsReply (LoraDeviceAddress deviceAddress)
 {
   // Throws out of range if no device is found
-  return m_endDeviceStatuses.at (deviceAddress)->NeedsReply ();
+  return m_endDeviceStatuses.at (deviceAddress.Get ())->NeedsReply ();
 }
 
 Address
 NetworkStatus::GetBestGatewayForDevice (LoraDeviceAddress deviceAddress, int window)
 {
-  // Get the endDeviceStatus we are interested in
-  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.at (deviceAddress);
+  // Throws out of range if no device is found
+  Ptr<GatewayStatus> gwStatus =
+    GetBestGatewayForDevice (m_endDeviceStatuses.at (deviceAddress.Get ()), window);
+  if (gwStatus)
+    {
+      return gwStatus->GetAddress ();
+    }
+  return Address ();
+}
+
+Ptr<GatewayStatus>
+NetworkStatus::GetBestGatewayForDevice (Ptr<EndDeviceStatus> edStatus, int window)
+{
   double replyFrequency;
   if (window == 1)
     {
@@ -145,24 +146,25 @@ NetworkStatus::GetBestGatewayForDevice (LoraDeviceAddress deviceAddress, int win
   // Get the list of gateways that this device can reach
   // NOTE: At this point, we could also take into account the whole network to
   // identify the best gateway according to various metrics. For now, we just
-  // ask the EndDeviceStatus to pick the best gateway for us via its method.
-  std::map<double, Address> gwAddresses = edStatus->GetPowerGatewayMap ();
-
-  // By iterating on the map in reverse, we go from the 'best'
-  // gateway, i.e. the one with the highest received power, to the
-  // worst.
-  Address bestGwAddress;
-  for (auto it = gwAddresses.rbegin(); it != gwAddresses.rend(); it++)
+  // pick the available gateway with the highest received power. Gateway
+  // statuses were resolved when the packet was received, so no lookup by
+  // address is needed here.
+  const EndDeviceStatus::GatewayList &gwList = edStatus->GetLastGatewayList ();
+
+  Ptr<GatewayStatus> bestGwStatus = 0;
+  double bestRxPower = 0;
+  for (auto it = gwList.begin (); it != gwList.end (); it++)
     {
-      bool isAvailable = m_gatewayStatuses.find(it->second)->second->IsAvailableForTransmission (replyFrequency);
-      if (isAvailable)
+      const EndDeviceStatus::PacketInfoPerGw &gwInfo = it->second;
+      if (gwInfo.gwStatus && (!bestGwStatus || gwInfo.rxPower > bestRxPower)
+          && gwInfo.gwStatus->IsAvailableForTransmission (replyFrequency))
         {
-          bestGwAddress = it->second;
-          break;
+          bestGwStatus = gwInfo.gwStatus;
+          bestRxPower = gwInfo.rxPower;
         }
     }
 
-  return bestGwAddress;
+  return bestGwStatus;
 }
 
 void
@@ -170,16 +172,28 @@ NetworkStatus::SendThroughGateway (Ptr<Packet> packet, Address gwAddress)
 {
   NS_LOG_FUNCTION (packet << gwAddress);
 
-  m_gatewayStatuses.find (gwAddress)->second->GetNetDevice ()->Send (packet,
-                                                                      gwAddress,
-                                                                      0x0800);
+  SendThroughGateway (packet, GetGatewayStatus (gwAddress));
+}
+
+void
+NetworkStatus::SendThroughGateway (Ptr<Packet> packet, Ptr<GatewayStatus> gwStatus)
+{
+  NS_LOG_FUNCTION (packet << gwStatus);
+
+  gwStatus->GetNetDevice ()->Send (packet, gwStatus->GetAddress (), 0x0800);
 }
 
 Ptr<Packet>
 NetworkStatus::GetReplyForDevice (LoraDeviceAddress edAddress, int windowNumber)
+{
+  return GetReplyForDevice (m_endDeviceStatuses.find (edAddress.Get ())->second,
+                            windowNumber);
+}
+
+Ptr<Packet>
+NetworkStatus::GetReplyForDevice (Ptr<EndDeviceStatus> edStatus, int windowNumber)
 {
   // Get the reply packet
-  Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.find (edAddress)->second;
   Ptr<Packet> packet = edStatus->GetCompleteReplyPacket ();
 
   // Apply the appropriate tag
@@ -195,6 +209,7 @@ NetworkStatus::GetReplyForDevice (LoraDeviceAddress edAddress, int windowNumber)
       tag.SetFrequency (edStatus->GetSecondReceiveWindowFrequency ());
       break;
     }
+  tag.SetDestination (edStatus->GetEndDeviceAddress ());
 
   packet->AddPacketTag (tag);
   return packet;
@@ -211,7 +226,7 @@ NetworkStatus::GetEndDeviceStatus (Ptr<Packet const> packet)
   Ptr<Packet> myPacket = packet->Copy ();
   myPacket->RemoveHeader (mHdr);
   myPacket->RemoveHeader (fHdr);
-  auto it = m_endDeviceStatuses.find (fHdr.GetAddress ());
+  auto it = m_endDeviceStatuses.find (fHdr.GetAddress ().Get ());
   if (it != m_endDeviceStatuses.end ())
     {
       return (*it).second;
@@ -228,7 +243,7 @@ NetworkStatus::GetEndDeviceStatus (LoraDeviceAddress address)
 {
   NS_LOG_FUNCTION (this << address);
 
-  auto it = m_endDeviceStatuses.find (address);
+  auto it = m_endDeviceStatuses.find (address.Get ());
   if (it != m_endDeviceStatuses.end ())
     {
       return (*it).second;
@@ -240,6 +255,23 @@ NetworkStatus::GetEndDeviceStatus (LoraDeviceAddress address)
     }
 }
 
+Ptr<GatewayStatus>
+NetworkStatus::GetGatewayStatus (const Address &address)
+{
+  NS_LOG_FUNCTION (this << address);
+
+  auto it = m_gatewayIndices.find (address);
+  if (it != m_gatewayIndices.end ())
+    {
+      return m_gatewayStatuses[it->second];
+    }
+  else
+    {
+      NS_LOG_ERROR ("GatewayStatus not found");
+      return 0;
+    }
+}
+
 int
 NetworkStatus::CountEndDevices (void)
 {
@@ -247,5 +279,13 @@ NetworkStatus::CountEndDevices (void)
 
   return m_endDeviceStatuses.size ();
 }
+
+int
+NetworkStatus::CountGateways (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  return m_gatewayStatuses.size ();
+}
 }
 }
@@ -27,17 +27,26 @@
 #include "ns3/gateway-status.h"
 #include "ns3/lora-device-address.h"
 #include "ns3/network-scheduler.h"
+#include "ns3/uplink-context.h"
 
 #include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
 
 /**
  * This class represents the knowledge about the state of the network that is
- * available at the Network Server. It is essentially a collection of two maps:
- * one containing DeviceStatus objects, and the other containing GatewayStatus
- * objects.
+ * available at the Network Server. It is essentially a collection of two
+ * registries: one containing DeviceStatus objects, hashed by the 32-bit device
+ * address, and the other containing GatewayStatus objects, stored in a dense
+ * vector and indexed by their Address.
+ *
+ * The EndDeviceStatus and GatewayStatus pointers it returns never change for a
+ * given device or gateway, so they can be kept and used in place of the
+ * addresses to avoid repeated lookups.
  *
  * This class is meant to be queried by NetworkController components, which
  * can decide to take action based on the current status of the network.
@@ -65,10 +74,9 @@ public:
   /**
    * Update network status on the received packet.
    *
-   * \param packet the received packet.
-   * \param address the gateway this packet was received from.
+   * \param context the received uplink.
    */
-  void OnReceivedPacket (Ptr<const Packet> packet, const Address &gwaddress);
+  void OnReceivedPacket (Ptr<const UplinkContext> context);
 
   /**
    * Return whether the specified device needs a reply.
@@ -85,6 +93,16 @@ public:
    */
   Address GetBestGatewayForDevice (LoraDeviceAddress deviceAddress, int window);
 
+  /**
+   * Get the best gateway that is available to send a reply to a device.
+   *
+   * \param edStatus the status of the device we are interested in.
+   * \param window the receive window the reply would be sent in.
+   * \return the status of the gateway, or 0 if no gateway is available.
+   */
+  Ptr<GatewayStatus> GetBestGatewayForDevice (Ptr<EndDeviceStatus> edStatus,
+                                              int window);
+
   /**
    * Send a packet through a Gateway.
    *
@@ -94,11 +112,21 @@ public:
    */
   void SendThroughGateway (Ptr<Packet> packet, Address gwAddress);
 
+  /**
+   * Send a packet through a Gateway, given its status.
+   */
+  void SendThroughGateway (Ptr<Packet> packet, Ptr<GatewayStatus> gwStatus);
+
   /**
    * Get the reply for the specified device address.
    */
   Ptr<Packet> GetReplyForDevice (LoraDeviceAddress edAddress, int windowNumber);
 
+  /**
+   * Get the reply for a device, given its status.
+   */
+  Ptr<Packet> GetReplyForDevice (Ptr<EndDeviceStatus> edStatus, int windowNumber);
+
   /**
    * Get the EndDeviceStatus for the device that sent a packet.
    */
@@ -109,14 +137,39 @@ public:
    */
   Ptr<EndDeviceStatus> GetEndDeviceStatus (LoraDeviceAddress address);
 
+  /**
+   * Get the GatewayStatus corresponding to a gateway Address.
+   *
+   * \return the status, or 0 if the gateway is unknown.
+   */
+  Ptr<GatewayStatus> GetGatewayStatus (const Address &address);
+
   /**
    * Return the number of end devices currently managed by the server.
    */
   int CountEndDevices (void);
 
-public:
-  std::map<LoraDeviceAddress, Ptr<EndDeviceStatus>> m_endDeviceStatuses;
-  std::map<Address, Ptr<GatewayStatus>> m_gatewayStatuses;
+  /**
+   * Return the number of gateways connected to the server.
+   */
+  int CountGateways (void);
+
+private:
+  /**
+   * The EndDeviceStatus of each device, keyed by the 32-bit form of its
+   * address.
+   */
+  std::unordered_map<uint32_t, Ptr<EndDeviceStatus> > m_endDeviceStatuses;
+
+  /**
+   * The GatewayStatus of each gateway, in the order they were added.
+   */
+  std::vector<Ptr<GatewayStatus> > m_gatewayStatuses;
+
+  /**
+   * The position of each gateway in m_gatewayStatuses.
+   */
+  std::map<Address, uint32_t> m_gatewayIndices;
 };
 
 } // namespace lorawan
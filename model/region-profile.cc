@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/region-profile.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("RegionProfile");
+
+RegionProfile::RegionProfile () :
+  m_replyDataRateMatrix ()
+{
+}
+
+RegionProfile::~RegionProfile ()
+{
+}
+
+void
+RegionProfile::AddSubBand (double firstFrequency, double lastFrequency,
+                           double dutyCycle, double maxTxPowerDbm)
+{
+  NS_LOG_FUNCTION (this << firstFrequency << lastFrequency);
+
+  SubBandParameters subBand;
+  subBand.firstFrequency = firstFrequency;
+  subBand.lastFrequency = lastFrequency;
+  subBand.dutyCycle = dutyCycle;
+  subBand.maxTxPowerDbm = maxTxPowerDbm;
+  m_subBands.push_back (subBand);
+}
+
+void
+RegionProfile::AddChannel (Ptr<LogicalLoraChannel> logicalChannel)
+{
+  NS_LOG_FUNCTION (this << logicalChannel);
+
+  m_channels.push_back (logicalChannel);
+}
+
+void
+RegionProfile::ConfigureChannelHelper (LogicalLoraChannelHelper &channelHelper) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (const SubBandParameters &subBand : m_subBands)
+    {
+      channelHelper.AddSubBand (subBand.firstFrequency, subBand.lastFrequency,
+                                subBand.dutyCycle, subBand.maxTxPowerDbm);
+    }
+
+  for (const Ptr<LogicalLoraChannel> &channel : m_channels)
+    {
+      channelHelper.AddSharedChannel (channel);
+    }
+}
+
+void
+RegionProfile::SetSfForDataRate (std::vector<uint8_t> sfForDataRate)
+{
+  m_sfForDataRate = sfForDataRate;
+}
+
+const std::vector<uint8_t> &
+RegionProfile::GetSfForDataRate (void) const
+{
+  return m_sfForDataRate;
+}
+
+void
+RegionProfile::SetBandwidthForDataRate (std::vector<double> bandwidthForDataRate)
+{
+  m_bandwidthForDataRate = bandwidthForDataRate;
+}
+
+const std::vector<double> &
+RegionProfile::GetBandwidthForDataRate (void) const
+{
+  return m_bandwidthForDataRate;
+}
+
+void
+RegionProfile::SetMaxAppPayloadForDataRate (std::vector<uint32_t> maxAppPayloadForDataRate)
+{
+  m_maxAppPayloadForDataRate = maxAppPayloadForDataRate;
+}
+
+const std::vector<uint32_t> &
+RegionProfile::GetMaxAppPayloadForDataRate (void) const
+{
+  return m_maxAppPayloadForDataRate;
+}
+
+void
+RegionProfile::SetTxDbmForTxPower (std::vector<double> txDbmForTxPower)
+{
+  m_txDbmForTxPower = txDbmForTxPower;
+}
+
+const std::vector<double> &
+RegionProfile::GetTxDbmForTxPower (void) const
+{
+  return m_txDbmForTxPower;
+}
+
+void
+RegionProfile::SetReplyDataRateMatrix (ReplyDataRateMatrix replyDataRateMatrix)
+{
+  m_replyDataRateMatrix = replyDataRateMatrix;
+}
+
+const RegionProfile::ReplyDataRateMatrix &
+RegionProfile::GetReplyDataRateMatrix (void) const
+{
+  return m_replyDataRateMatrix;
+}
+
+} /* namespace lorawan */
+} /* namespace ns3 */
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REGION_PROFILE_H
+#define REGION_PROFILE_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/logical-lora-channel.h"
+#include "ns3/logical-lora-channel-helper.h"
+#include <array>
+#include <vector>
+
+namespace ns3 {
+namespace lorawan {
+
+/**
+ * Class holding the regional parameters of a LoRaWAN region: SubBands,
+ * default channels and DataRate conversion tables.
+ *
+ * A RegionProfile is meant to be shared, through a Ptr<const RegionProfile>,
+ * by all the MAC layers configured for the same region. It is never modified
+ * once shared: a MAC that needs different parameters works on its own copy.
+ */
+class RegionProfile : public SimpleRefCount<RegionProfile>
+{
+public:
+  typedef std::array<std::array<uint8_t, 6>, 8> ReplyDataRateMatrix;
+
+  RegionProfile ();
+  ~RegionProfile ();
+
+  /**
+   * Add a SubBand to this region.
+   *
+   * \param firstFrequency The first frequency of the SubBand, in MHz.
+   * \param lastFrequency The last frequency of the SubBand, in MHz.
+   * \param dutyCycle The duty cycle that needs to be enforced on this SubBand.
+   * \param maxTxPowerDbm The maximum transmission power allowed on this
+   * SubBand.
+   */
+  void AddSubBand (double firstFrequency, double lastFrequency,
+                   double dutyCycle, double maxTxPowerDbm);
+
+  /**
+   * Add a default channel to this region.
+   *
+   * The channel is shared by all the LogicalLoraChannelHelper instances this
+   * profile configures, and must not be modified after this call.
+   *
+   * \param logicalChannel The channel to add.
+   */
+  void AddChannel (Ptr<LogicalLoraChannel> logicalChannel);
+
+  /**
+   * Add the SubBands and the default channels of this region to a
+   * LogicalLoraChannelHelper.
+   *
+   * SubBands keep track of the duty cycle of a device, so each helper gets its
+   * own. Channels are shared, and only copied by the helper when they are
+   * modified.
+   *
+   * \param channelHelper The helper to configure.
+   */
+  void ConfigureChannelHelper (LogicalLoraChannelHelper &channelHelper) const;
+
+  /**
+   * Set the vector to use to check up correspondence between SF and DataRate.
+   */
+  void SetSfForDataRate (std::vector<uint8_t> sfForDataRate);
+
+  /**
+   * Get the SF each DataRate corresponds to.
+   */
+  const std::vector<uint8_t> &GetSfForDataRate (void) const;
+
+  /**
+   * Set the vector to use to check up correspondence between bandwidth and
+   * DataRate.
+   */
+  void SetBandwidthForDataRate (std::vector<double> bandwidthForDataRate);
+
+  /**
+   * Get the bandwidth each DataRate corresponds to.
+   */
+  const std::vector<double> &GetBandwidthForDataRate (void) const;
+
+  /**
+   * Set the maximum App layer payload for each DataRate.
+   */
+  void SetMaxAppPayloadForDataRate (std::vector<uint32_t> maxAppPayloadForDataRate);
+
+  /**
+   * Get the maximum App layer payload for each DataRate.
+   */
+  const std::vector<uint32_t> &GetMaxAppPayloadForDataRate (void) const;
+
+  /**
+   * Set the transmission power in dBm each TxPower value corresponds to.
+   */
+  void SetTxDbmForTxPower (std::vector<double> txDbmForTxPower);
+
+  /**
+   * Get the transmission power in dBm each TxPower value corresponds to.
+   */
+  const std::vector<double> &GetTxDbmForTxPower (void) const;
+
+  /**
+   * Set the matrix to use when deciding with which DataRate to respond.
+   */
+  void SetReplyDataRateMatrix (ReplyDataRateMatrix replyDataRateMatrix);
+
+  /**
+   * Get the matrix to use when deciding with which DataRate to respond.
+   */
+  const ReplyDataRateMatrix &GetReplyDataRateMatrix (void) const;
+
+private:
+  /**
+   * The parameters needed to create a SubBand.
+   */
+  struct SubBandParameters
+  {
+    double firstFrequency; //!< The first frequency of the SubBand
+    double lastFrequency;  //!< The last frequency of the SubBand
+    double dutyCycle;      //!< The duty cycle of the SubBand
+    double maxTxPowerDbm;  //!< The maximum transmission power of the SubBand
+  };
+
+  std::vector<SubBandParameters> m_subBands; //!< The SubBands of the region
+
+  std::vector<Ptr<LogicalLoraChannel> > m_channels; //!< The default channels
+
+  std::vector<uint8_t> m_sfForDataRate; //!< The SF of each DataRate
+
+  std::vector<double> m_bandwidthForDataRate; //!< The bandwidth of each DataRate
+
+  std::vector<uint32_t> m_maxAppPayloadForDataRate; //!< The max payload of each DataRate
+
+  std::vector<double> m_txDbmForTxPower; //!< The power of each TxPower value
+
+  ReplyDataRateMatrix m_replyDataRateMatrix; //!< The reply DataRates
+};
+
+} /* namespace lorawan */
+
+} /* namespace ns3 */
+#endif /* REGION_PROFILE_H */
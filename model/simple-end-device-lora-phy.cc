@@ -133,7 +133,7 @@ SimpleEndDeviceLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
   // still incoming.
 
   Ptr<LoraInterferenceHelper::Event> event;
-  event = m_interference.Add (duration, rxPowerDbm, sf, packet, frequencyMHz);
+  event = AddInterferenceEvent (duration, rxPowerDbm, sf, packet, frequencyMHz);
 
   // Switch on the current PHY state
   switch (m_state)
@@ -241,13 +241,13 @@ SimpleEndDeviceLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm,
             // Switch to RX state
             // EndReceive will handle the switch back to STANDBY state
             SwitchToRx ();
+            LockOnInterferenceEvent (event);
 
             // Schedule the end of the reception of the packet
             NS_LOG_INFO ("Scheduling reception of a packet. End in " <<
                          duration.GetSeconds () << " seconds");
 
-            Simulator::Schedule (duration, &LoraPhy::EndReceive, this, packet,
-                                 event);
+            ScheduleEndReceive (duration, packet, event);
 
             // Fire the beginning of reception trace source
             m_phyRxBeginTrace (packet);
@@ -270,7 +270,7 @@ SimpleEndDeviceLoraPhy::EndReceive (Ptr<Packet> packet,
 
   // Call the LoraInterferenceHelper to determine whether there was destructive
   // interference on this event.
-  bool packetDestroyed = m_interference.IsDestroyedByInterference (event);
+  bool packetDestroyed = IsDestroyedByInterference (event);
 
   // Fire the trace source if packet was destroyed
   if (packetDestroyed)
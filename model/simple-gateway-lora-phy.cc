@@ -22,6 +22,7 @@
 #include "ns3/lora-tag.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 namespace ns3 {
 namespace lorawan {
@@ -45,7 +46,7 @@ SimpleGatewayLoraPhy::GetTypeId (void)
   return tid;
 }
 
-SimpleGatewayLoraPhy::SimpleGatewayLoraPhy ()
+SimpleGatewayLoraPhy::SimpleGatewayLoraPhy () : m_outcomesTime (Seconds (-1))
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -66,40 +67,36 @@ SimpleGatewayLoraPhy::Send (Ptr<Packet> packet, LoraTxParameters txParams, doubl
 
   NS_LOG_DEBUG ("Duration of packet: " << duration << ", SF" << unsigned (txParams.sf));
 
-  // Interrupt all receive operations
-  std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath>>::iterator it;
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
+  //Check if Tx priority. If not, let Rx be and cancel the Tx
+  if (!m_tx_priority && m_occupiedReceptionPaths > 0)
     {
+      NS_LOG_DEBUG ("Gateway Tx priority is false, since it is already in reception, ignoring the Tx");
+      return;
+    }
 
-      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+  // Interrupt all receive operations
+  for (int32_t index = GetNextOccupiedReceptionPath (0); index >= 0;
+       index = GetNextOccupiedReceptionPath (index + 1))
+    {
+      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = m_receptionPaths[index];
 
-      if (!currentPath->IsAvailable ()) // Reception path is occupied
+      // Call the callback for reception interrupted by transmission
+      // Fire the trace source
+      if (m_device)
         {
-            //Check if Tx priority. If not, let Rx be and cancel the Tx
-            if(!m_tx_priority){
-                NS_LOG_DEBUG("Gateway Tx priority is false, since it is already in reception, ignoring the Tx");
-                return;
-            }
-
-          // Call the callback for reception interrupted by transmission
-          // Fire the trace source
-          if (m_device)
-            {
-              m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (),
-                                                m_device->GetNode ()->GetId ());
-            }
-          else
-            {
-              m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (), 0);
-            }
+          m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (),
+                                            m_device->GetNode ()->GetId ());
+        }
+      else
+        {
+          m_noReceptionBecauseTransmitting (currentPath->GetEvent ()->GetPacket (), 0);
+        }
 
-          // Cancel the scheduled EndReceive call
-          Simulator::Cancel (currentPath->GetEndReceive ());
+      // Cancel the scheduled EndReceive call
+      Simulator::Cancel (currentPath->GetEndReceive ());
 
-          // Free it
-          // This also resets all parameters like packet and endReceive call
-          currentPath->Free ();
-        }
+      // Free it
+      FreeReceptionPath (index);
     }
 
   // Send the packet in the channel
@@ -159,60 +156,52 @@ SimpleGatewayLoraPhy::StartReceive (Ptr<Packet> packet, double rxPowerDbm, uint8
 
   // Add the event to the LoraInterferenceHelper
   Ptr<LoraInterferenceHelper::Event> event;
-  event = m_interference.Add (duration, rxPowerDbm, sf, packet, frequencyMHz);
-
-  // Cycle over the receive paths to check availability to receive the packet
-  std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath>>::iterator it;
+  event = AddInterferenceEvent (duration, rxPowerDbm, sf, packet, frequencyMHz);
 
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
+  // Look for a free receive path to receive the packet
+  int32_t index = GetNextFreeReceptionPath (0);
+  if (index >= 0)
     {
-      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = m_receptionPaths[index];
 
-      // If the receive path is available and listening on the channel of
-      // interest, we have a candidate
-      if (currentPath->IsAvailable ())
+      // See whether the reception power is above or below the sensitivity
+      // for that spreading factor
+      double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned (sf) - 7];
+
+      if (rxPowerDbm < sensitivity) // Packet arrived below sensitivity
         {
-          // See whether the reception power is above or below the sensitivity
-          // for that spreading factor
-          double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned (sf) - 7];
+          NS_LOG_INFO ("Dropping packet reception of packet with sf = "
+                       << unsigned (sf) << " because under the sensitivity of " << sensitivity
+                       << " dBm");
 
-          if (rxPowerDbm < sensitivity) // Packet arrived below sensitivity
+          if (m_device)
             {
-              NS_LOG_INFO ("Dropping packet reception of packet with sf = "
-                           << unsigned (sf) << " because under the sensitivity of " << sensitivity
-                           << " dBm");
-
-              if (m_device)
-                {
-                  m_underSensitivity (packet, m_device->GetNode ()->GetId ());
-                }
-              else
-                {
-                  m_underSensitivity (packet, 0);
-                }
-
-              // Since the packet is below sensitivity, it makes no sense to
-              // search for another ReceivePath
-              return;
+              m_underSensitivity (packet, m_device->GetNode ()->GetId ());
             }
-          else // We have sufficient sensitivity to start receiving
+          else
             {
-              NS_LOG_INFO ("Scheduling reception of a packet, "
-                           << "occupying one demodulator");
+              m_underSensitivity (packet, 0);
+            }
 
-              // Block this resource
-              currentPath->LockOnEvent (event);
-              m_occupiedReceptionPaths++;
+          // Since the packet is below sensitivity, it makes no sense to
+          // search for another ReceivePath
+          return;
+        }
+      else // We have sufficient sensitivity to start receiving
+        {
+          NS_LOG_INFO ("Scheduling reception of a packet, "
+                       << "occupying one demodulator");
 
-              // Schedule the end of the reception of the packet
-              EventId endReceiveEventId =
-                  Simulator::Schedule (duration, &LoraPhy::EndReceive, this, packet, event);
+          // Block this resource
+          LockReceptionPath (index, event);
+          LockOnInterferenceEvent (event);
 
-              currentPath->SetEndReceive (endReceiveEventId);
+          // Schedule the end of the reception of the packet
+          EventId endReceiveEventId = ScheduleEndReceive (duration, packet, event);
 
-              // Make sure we don't go on searching for other ReceivePaths
-              return;
-            }
+          currentPath->SetEndReceive (endReceiveEventId);
+
+          return;
         }
     }
   // If we get to this point, there are no demodulators we can use
@@ -243,7 +232,7 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet, Ptr<LoraInterferenceHelper
   // destructive interference. If the packet is correctly received, this
   // method returns a 0.
   uint8_t packetDestroyed = 0;
-  packetDestroyed = m_interference.IsDestroyedByInterference (event);
+  packetDestroyed = GetReceptionOutcome (event);
 
   // Check whether the packet was destroyed
   if (packetDestroyed != uint8_t (0))
@@ -306,21 +295,49 @@ SimpleGatewayLoraPhy::EndReceive (Ptr<Packet> packet, Ptr<LoraInterferenceHelper
         }
     }
 
-  // Search for the demodulator that was locked on this event to free it.
+  // Free the demodulator that was locked on this event
+  int32_t index = event->GetReceptionPath ();
+  if (index >= 0 && std::size_t (index) < m_receptionPaths.size () &&
+      m_receptionPaths[index]->GetEvent () == event)
+    {
+      FreeReceptionPath (index);
+    }
+}
 
-  std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath>>::iterator it;
+uint8_t
+SimpleGatewayLoraPhy::GetReceptionOutcome (Ptr<LoraInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (this << event);
 
-  for (it = m_receptionPaths.begin (); it != m_receptionPaths.end (); ++it)
+  if (m_outcomesTime != Simulator::Now ())
     {
-      Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+      m_outcomeEvents.clear ();
+      m_outcomes.clear ();
+    }
 
-      if (currentPath->GetEvent () == event)
+  auto found = std::find (m_outcomeEvents.begin (), m_outcomeEvents.end (), event);
+  if (found == m_outcomeEvents.end ())
+    {
+      // Score all the receptions that end now at once
+      m_outcomeEvents.clear ();
+      m_outcomeEvents.push_back (event);
+      for (int32_t index = GetNextOccupiedReceptionPath (0); index >= 0;
+           index = GetNextOccupiedReceptionPath (index + 1))
         {
-          currentPath->Free ();
-          m_occupiedReceptionPaths--;
-          return;
+          Ptr<LoraInterferenceHelper::Event> pathEvent = m_receptionPaths[index]->GetEvent ();
+          if (pathEvent != event && pathEvent->GetEndTime () == Simulator::Now ())
+            {
+              m_outcomeEvents.push_back (pathEvent);
+            }
         }
+      NS_LOG_DEBUG ("Scoring " << m_outcomeEvents.size () << " receptions ending now");
+
+      IsDestroyedByInterference (m_outcomeEvents, m_outcomes);
+      m_outcomesTime = Simulator::Now ();
+      found = m_outcomeEvents.begin ();
     }
+
+  return m_outcomes[found - m_outcomeEvents.begin ()];
 }
 
 } // namespace lorawan
@@ -29,6 +29,7 @@
 #include "ns3/gateway-lora-phy.h"
 #include "ns3/traced-value.h"
 #include <list>
+#include <vector>
 
 namespace ns3 {
 namespace lorawan {
@@ -56,6 +57,27 @@ public:
                      double frequencyMHz, double txPowerDbm);
 
 private:
+  /**
+   * Determine whether an event was destroyed by interference.
+   *
+   * The outcomes of all receptions that end at the current time are computed
+   * together the first time this method is called at that time, and the
+   * following calls at the same time return the stored outcome.
+   *
+   * \param event The event for which to check the outcome.
+   * \return The sf of the packets that caused the loss, or 0 if there was no
+   * loss.
+   */
+  uint8_t GetReceptionOutcome (Ptr<LoraInterferenceHelper::Event> event);
+
+  Time m_outcomesTime; //!< The time the stored outcomes were computed at.
+
+  /**
+   * The receptions ending at m_outcomesTime, whose outcome is in m_outcomes.
+   */
+  std::vector<Ptr<LoraInterferenceHelper::Event>> m_outcomeEvents;
+
+  std::vector<uint8_t> m_outcomes; //!< The outcomes of m_outcomeEvents.
 };
 
 } /* namespace ns3 */
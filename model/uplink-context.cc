@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/uplink-context.h"
+#include "ns3/end-device-status.h"
+#include "ns3/gateway-status.h"
+#include "ns3/network-status.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+namespace lorawan {
+
+NS_LOG_COMPONENT_DEFINE ("UplinkContext");
+
+UplinkContext::UplinkContext (Ptr<const Packet> packet, const Address &gwAddress,
+                              Ptr<NetworkStatus> networkStatus) :
+  m_packet (packet),
+  m_gwAddress (gwAddress)
+{
+  NS_LOG_FUNCTION (this << packet << gwAddress);
+
+  // Extract the headers
+  Ptr<Packet> packetCopy = packet->Copy ();
+  packetCopy->RemoveHeader (m_macHeader);
+  m_frameHeader.SetAsUplink ();
+  packetCopy->RemoveHeader (m_frameHeader);
+  packet->PeekPacketTag (m_tag);
+
+  NS_LOG_DEBUG ("Mac Header: " << m_macHeader);
+  NS_LOG_DEBUG ("Frame Header: " << m_frameHeader);
+
+  if (networkStatus)
+    {
+      m_endDeviceStatus = networkStatus->GetEndDeviceStatus (m_frameHeader.GetAddress ());
+      m_gatewayStatus = networkStatus->GetGatewayStatus (gwAddress);
+    }
+}
+
+UplinkContext::~UplinkContext ()
+{
+}
+
+Ptr<const Packet>
+UplinkContext::GetPacket (void) const
+{
+  return m_packet;
+}
+
+const Address &
+UplinkContext::GetGatewayAddress (void) const
+{
+  return m_gwAddress;
+}
+
+const LorawanMacHeader &
+UplinkContext::GetMacHeader (void) const
+{
+  return m_macHeader;
+}
+
+const LoraFrameHeader &
+UplinkContext::GetFrameHeader (void) const
+{
+  return m_frameHeader;
+}
+
+const LoraTag &
+UplinkContext::GetTag (void) const
+{
+  return m_tag;
+}
+
+LoraDeviceAddress
+UplinkContext::GetDeviceAddress (void) const
+{
+  return m_frameHeader.GetAddress ();
+}
+
+Ptr<EndDeviceStatus>
+UplinkContext::GetEndDeviceStatus (void) const
+{
+  return m_endDeviceStatus;
+}
+
+Ptr<GatewayStatus>
+UplinkContext::GetGatewayStatus (void) const
+{
+  return m_gatewayStatus;
+}
+
+} /* namespace lorawan */
+} /* namespace ns3 */
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef UPLINK_CONTEXT_H
+#define UPLINK_CONTEXT_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-device-address.h"
+#include "ns3/lora-tag.h"
+
+namespace ns3 {
+namespace lorawan {
+
+class EndDeviceStatus;
+class GatewayStatus;
+class NetworkStatus;
+
+/**
+ * The information the Network Server extracts from an uplink packet forwarded
+ * by a gateway.
+ *
+ * The headers and the LoraTag of the packet are read, and the EndDeviceStatus
+ * of the sender and the GatewayStatus of the forwarding gateway are looked up,
+ * once when the packet enters the Network Server.
+ * The context is then passed, instead of the packet, to all the components
+ * that need to know about the uplink, and is never modified.
+ */
+class UplinkContext : public SimpleRefCount<UplinkContext>
+{
+public:
+  /**
+   * Read the headers and tag of an uplink packet.
+   *
+   * \param packet The packet, as forwarded by the gateway.
+   * \param gwAddress The address of the gateway that forwarded the packet.
+   * \param networkStatus The NetworkStatus to look up the sender and the
+   * gateway in, or 0 if their statuses are not needed.
+   */
+  UplinkContext (Ptr<const Packet> packet, const Address &gwAddress,
+                 Ptr<NetworkStatus> networkStatus);
+  ~UplinkContext ();
+
+  /**
+   * Get the packet, headers included.
+   */
+  Ptr<const Packet> GetPacket (void) const;
+
+  /**
+   * Get the address of the gateway that forwarded the packet.
+   */
+  const Address &GetGatewayAddress (void) const;
+
+  /**
+   * Get the MAC header of the packet.
+   */
+  const LorawanMacHeader &GetMacHeader (void) const;
+
+  /**
+   * Get the frame header of the packet.
+   */
+  const LoraFrameHeader &GetFrameHeader (void) const;
+
+  /**
+   * Get the LoraTag the gateway attached to the packet.
+   */
+  const LoraTag &GetTag (void) const;
+
+  /**
+   * Get the address of the device that sent the packet.
+   */
+  LoraDeviceAddress GetDeviceAddress (void) const;
+
+  /**
+   * Get the EndDeviceStatus of the device that sent the packet.
+   *
+   * \return The status, or 0 if the device is unknown to the NetworkStatus.
+   */
+  Ptr<EndDeviceStatus> GetEndDeviceStatus (void) const;
+
+  /**
+   * Get the GatewayStatus of the gateway that forwarded the packet.
+   *
+   * \return The status, or 0 if the gateway is unknown to the NetworkStatus.
+   */
+  Ptr<GatewayStatus> GetGatewayStatus (void) const;
+
+private:
+  Ptr<const Packet> m_packet; //!< The received packet
+
+  Address m_gwAddress; //!< The gateway that forwarded the packet
+
+  LorawanMacHeader m_macHeader; //!< The MAC header of the packet
+
+  LoraFrameHeader m_frameHeader; //!< The frame header of the packet
+
+  LoraTag m_tag; //!< The tag set by the gateway
+
+  Ptr<EndDeviceStatus> m_endDeviceStatus; //!< The status of the sender
+
+  Ptr<GatewayStatus> m_gatewayStatus; //!< The status of the gateway
+};
+
+} /* namespace lorawan */
+
+} /* namespace ns3 */
+#endif /* UPLINK_CONTEXT_H */
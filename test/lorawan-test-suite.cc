@@ -8,6 +8,13 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/one-shot-sender-helper.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/beacon-timer.h"
+#include "ns3/lora-beacon-tag.h"
+#include <chrono>
+#include <cmath>
+#include <random>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -105,6 +112,17 @@ InterferenceTest::DoRun (void)
                          "Packet was not destroyed by interference as expected");
   interferenceHelper.ClearAllEvents ();
 
+  // Perfect overlap, packet destroyed, with interference energy accumulated
+  // while the packet is being received
+  LoraInterferenceHelper::incrementalEnergy = true;
+  event = interferenceHelper.Add (Seconds (2), 14, 7, 0, frequency);
+  interferenceHelper.TrackEvent (event);
+  interferenceHelper.Add (Seconds (2), 14 - 6, 7, 0, frequency);
+  NS_TEST_EXPECT_MSG_EQ (interferenceHelper.IsDestroyedByInterference (event), 7,
+                         "Packet was not destroyed by interference as expected");
+  interferenceHelper.ClearAllEvents ();
+  LoraInterferenceHelper::incrementalEnergy = false;
+
   // Partial overlap, packet survives
   event = interferenceHelper.Add (Seconds (2), 14, 7, 0, frequency);
   interferenceHelper.Add (Seconds (1), 14 - 6, 7, 0, frequency);
@@ -166,6 +184,139 @@ InterferenceTest::DoRun (void)
   interferenceHelper.ClearAllEvents ();
 }
 
+/**************************
+ * InterferenceKernelTest *
+ **************************/
+
+class InterferenceKernelTest : public TestCase
+{
+public:
+  InterferenceKernelTest ();
+  virtual ~InterferenceKernelTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the outcome of random receptions against the SNIR computation in
+   * the logarithmic domain, and compare the time both take.
+   */
+  void CheckMatrix (LoraInterferenceHelper::CollisionMatrix matrix,
+                    const std::vector<std::vector<double>> &collisionSnir);
+};
+
+InterferenceKernelTest::InterferenceKernelTest ()
+    : TestCase ("Verify that the SNIR evaluation of LoraInterferenceHelper matches the "
+                "computation in dB")
+{
+}
+
+InterferenceKernelTest::~InterferenceKernelTest ()
+{
+}
+
+// The outcome of a reception, computed with one logarithm per SF as
+// LoraInterferenceHelper used to do
+static uint8_t
+ReferenceOutcome (Ptr<LoraInterferenceHelper::Event> event, const std::vector<double> &energy,
+                  const std::vector<std::vector<double>> &collisionSnir)
+{
+  uint8_t sf = event->GetSpreadingFactor ();
+  double signalEnergy = event->GetDuration ().GetSeconds () * event->GetRxPowerW ();
+  for (uint8_t currentSf = uint8_t (7); currentSf <= uint8_t (12); currentSf++)
+    {
+      double snirIsolation = collisionSnir[unsigned (sf) - 7][unsigned (currentSf) - 7];
+      double snir = 10 * log10 (signalEnergy / energy.at (unsigned (currentSf) - 7));
+      if (snir < snirIsolation)
+        {
+          return currentSf;
+        }
+    }
+  return uint8_t (0);
+}
+
+void
+InterferenceKernelTest::CheckMatrix (LoraInterferenceHelper::CollisionMatrix matrix,
+                                     const std::vector<std::vector<double>> &collisionSnir)
+{
+  LoraInterferenceHelper::CollisionMatrix previousMatrix = LoraInterferenceHelper::collisionMatrix;
+  LoraInterferenceHelper::collisionMatrix = matrix;
+  LoraInterferenceHelper interferenceHelper;
+  LoraInterferenceHelper::collisionMatrix = previousMatrix;
+
+  // Random receptions, where about a third of the SFs carry no interference
+  std::mt19937 generator (1);
+  std::uniform_real_distribution<double> power (-140, -80);
+  std::uniform_real_distribution<double> overlap (0, 2);
+  std::uniform_int_distribution<int> sf (7, 12);
+  std::uniform_int_distribution<int> silent (0, 2);
+
+  const std::size_t receptions = 10000;
+  std::vector<Ptr<LoraInterferenceHelper::Event>> events;
+  std::vector<double> energies (6 * receptions, 0);
+  for (std::size_t i = 0; i < receptions; i++)
+    {
+      events.push_back (Create<LoraInterferenceHelper::Event> (Seconds (overlap (generator)),
+                                                               power (generator),
+                                                               uint8_t (sf (generator)),
+                                                               Ptr<Packet> (), 868.1));
+      for (std::size_t j = 0; j < 6; j++)
+        {
+          if (silent (generator) != 0)
+            {
+              energies[6 * i + j] = pow (10, power (generator) / 10) / 1000 * overlap (generator);
+            }
+        }
+    }
+
+  std::vector<uint8_t> expected (receptions);
+  std::vector<uint8_t> outcomes (receptions);
+
+  auto start = std::chrono::steady_clock::now ();
+  for (std::size_t i = 0; i < receptions; i++)
+    {
+      std::vector<double> energy (energies.begin () + 6 * i, energies.begin () + 6 * (i + 1));
+      expected[i] = ReferenceOutcome (events[i], energy, collisionSnir);
+    }
+  auto referenceEnd = std::chrono::steady_clock::now ();
+  for (std::size_t i = 0; i < receptions; i++)
+    {
+      std::vector<double> energy (energies.begin () + 6 * i, energies.begin () + 6 * (i + 1));
+      outcomes[i] = interferenceHelper.IsDestroyedByInterference (events[i], energy);
+    }
+  auto singleEnd = std::chrono::steady_clock::now ();
+  std::vector<uint8_t> batchOutcomes;
+  interferenceHelper.IsDestroyedByInterference (events, energies, batchOutcomes);
+  auto batchEnd = std::chrono::steady_clock::now ();
+
+  typedef std::chrono::duration<double, std::micro> Microseconds;
+  double referenceTime = Microseconds (referenceEnd - start).count ();
+  double singleTime = Microseconds (singleEnd - referenceEnd).count ();
+  double batchTime = Microseconds (batchEnd - singleEnd).count ();
+  NS_LOG_INFO ("Scoring " << receptions << " receptions took " << referenceTime
+                          << " us in dB, " << singleTime << " us one at a time and "
+                          << batchTime << " us in a batch");
+
+  NS_TEST_ASSERT_MSG_EQ (batchOutcomes.size (), receptions,
+                         "The batch didn't give an outcome for each event");
+  for (std::size_t i = 0; i < receptions; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (unsigned (outcomes[i]), unsigned (expected[i]),
+                             "Outcome differs from the computation in dB");
+      NS_TEST_ASSERT_MSG_EQ (unsigned (batchOutcomes[i]), unsigned (expected[i]),
+                             "Batch outcome differs from the computation in dB");
+    }
+}
+
+void
+InterferenceKernelTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("InterferenceKernelTest");
+
+  CheckMatrix (LoraInterferenceHelper::GOURSAUD, LoraInterferenceHelper::collisionSnirGoursaud);
+  CheckMatrix (LoraInterferenceHelper::ALOHA, LoraInterferenceHelper::collisionSnirAloha);
+}
+
 /***************
  * AddressTest *
  ***************/
@@ -241,6 +392,33 @@ AddressTest::DoRun (void)
   // After 200 iterations, the address should be 0xC9
   NS_TEST_EXPECT_MSG_EQ ((addressGenerator.GetNextAddress () == LoraDeviceAddress (0xC9)), true,
                          "LoraDeviceAddressGenerator doesn't increment as expected");
+
+  // The broadcast address is never handed out
+  LoraDeviceAddressGenerator lastAddressGenerator (0x7F, 0x1FFFFFE);
+  NS_TEST_EXPECT_MSG_EQ (lastAddressGenerator.NextAddress ().IsBroadcast (), false,
+                         "LoraDeviceAddressGenerator handed out the broadcast address");
+  NS_TEST_EXPECT_MSG_EQ (lastAddressGenerator.NextAddress ().IsBroadcast (), false,
+                         "LoraDeviceAddressGenerator handed out the broadcast address");
+  NS_TEST_EXPECT_MSG_EQ (LoraDeviceAddressGenerator ().NextAddress ().IsBroadcast (), false,
+                         "LoraDeviceAddressGenerator handed out the broadcast address");
+
+  ///////////////////////////////////
+  // Test the PHY address filter
+  ///////////////////////////////////
+
+  Ptr<SimpleEndDeviceLoraPhy> phy = CreateObject<SimpleEndDeviceLoraPhy> ();
+  NS_TEST_EXPECT_MSG_EQ (phy->AcceptsAddress (firstAddress), true,
+                         "PHY without a filter rejected an address");
+
+  phy->SetAddressFilter (toSerialize);
+  NS_TEST_EXPECT_MSG_EQ (phy->AcceptsAddress (toSerialize), true,
+                         "PHY rejected its own address");
+  NS_TEST_EXPECT_MSG_EQ (phy->AcceptsAddress (LoraDeviceAddress::GetBroadcast ()), true,
+                         "PHY rejected the broadcast address");
+  NS_TEST_EXPECT_MSG_EQ (phy->AcceptsAddress (LoraDeviceAddress (0)), false,
+                         "PHY accepted address 0 as broadcast");
+  NS_TEST_EXPECT_MSG_EQ (phy->AcceptsAddress (firstAddress), false,
+                         "PHY accepted another device's address");
 }
 
 /***************
@@ -375,6 +553,100 @@ HeaderTest::DoRun (void)
                          "Removed header's MAC command contents don't match");
   NS_TEST_EXPECT_MSG_EQ (linkCheckAns->GetGwCnt (), 1,
                          "Removed header's MAC command contents don't match");
+
+  ///////////////////////////////////////////
+  // Round trips of a header with commands //
+  ///////////////////////////////////////////
+  LoraFrameHeader downlinkHdr;
+  downlinkHdr.SetAsDownlink ();
+  downlinkHdr.SetFCnt (2);
+  downlinkHdr.AddLinkAdrReq (5, 1, std::list<int>{0, 1, 2}, 1);
+  downlinkHdr.AddDutyCycleReq (4);
+  downlinkHdr.AddLinkCheckAns (20, 3);
+  NS_TEST_EXPECT_MSG_EQ (unsigned (downlinkHdr.GetFOptsLen ()), 5 + 2 + 3,
+                         "Wrong FOpts length");
+
+  const uint32_t roundTrips = 100000;
+  Buffer roundTripBuf;
+  roundTripBuf.AddAtStart (downlinkHdr.GetSerializedSize ());
+  LoraFrameHeader receivedHdr;
+  receivedHdr.SetAsDownlink ();
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < roundTrips; i++)
+    {
+      downlinkHdr.Serialize (roundTripBuf.Begin ());
+      receivedHdr.Deserialize (roundTripBuf.Begin ());
+    }
+  auto end = std::chrono::steady_clock::now ();
+
+  typedef std::chrono::duration<double, std::micro> Microseconds;
+  double roundTripTime = Microseconds (end - start).count ();
+  NS_LOG_INFO (roundTrips << " frame header round trips took " << roundTripTime << " us");
+
+  std::list<Ptr<MacCommand> > commands = receivedHdr.GetCommands ();
+  NS_TEST_ASSERT_MSG_EQ (commands.size (), 3, "Commands were lost in the round trips");
+  Ptr<LinkAdrReq> linkAdrReq = receivedHdr.GetMacCommand<LinkAdrReq> ();
+  NS_TEST_EXPECT_MSG_EQ (unsigned (linkAdrReq->GetDataRate ()), 5,
+                         "LinkAdrReq changes in the round trips");
+  NS_TEST_EXPECT_MSG_EQ (linkAdrReq->GetEnabledChannelsList ().size (), 3,
+                         "LinkAdrReq changes in the round trips");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (receivedHdr.GetMacCommand<LinkCheckAns> ()->GetGwCnt ()), 3,
+                         "LinkCheckAns changes in the round trips");
+  NS_TEST_EXPECT_MSG_EQ (receivedHdr.GetMacCommand<DevStatusReq> (), 0,
+                         "Found a command that is not in the header");
+
+  ///////////////////////////////////////////////////////////
+  // Commands written in place match their serialized form //
+  ///////////////////////////////////////////////////////////
+  LoraFrameHeader inPlaceHdr;
+  inPlaceHdr.SetAsDownlink ();
+  inPlaceHdr.AddLinkAdrReq (5, 1, std::list<int>{0, 1, 9}, 3);
+  inPlaceHdr.AddRxParamSetupReq (2, 3, 869525000);
+  inPlaceHdr.AddNewChannelReq (4, 867100000, 0, 5);
+
+  LoraFrameHeader objectHdr;
+  objectHdr.SetAsDownlink ();
+  objectHdr.AddCommand (Create<LinkAdrReq> (5, 1, 0b1000000011, 0, 3));
+  objectHdr.AddCommand (Create<RxParamSetupReq> (2, 3, 869525000));
+  objectHdr.AddCommand (Create<NewChannelReq> (4, 867100000, 0, 5));
+
+  auto checkSameBytes = [this] (LoraFrameHeader &inPlace, LoraFrameHeader &object) {
+    Buffer inPlaceBuf;
+    inPlaceBuf.AddAtStart (inPlace.GetSerializedSize ());
+    inPlace.Serialize (inPlaceBuf.Begin ());
+    Buffer objectBuf;
+    objectBuf.AddAtStart (object.GetSerializedSize ());
+    object.Serialize (objectBuf.Begin ());
+
+    NS_TEST_ASSERT_MSG_EQ (inPlaceBuf.GetSize (), objectBuf.GetSize (),
+                           "Commands written in place have the wrong size");
+    Buffer::Iterator inPlaceIt = inPlaceBuf.Begin ();
+    Buffer::Iterator objectIt = objectBuf.Begin ();
+    for (uint32_t i = 0; i < inPlaceBuf.GetSize (); i++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (unsigned (inPlaceIt.ReadU8 ()), unsigned (objectIt.ReadU8 ()),
+                               "Commands written in place differ from their serialized form");
+      }
+  };
+  checkSameBytes (inPlaceHdr, objectHdr);
+
+  LoraFrameHeader uplinkHdr;
+  uplinkHdr.SetAsUplink ();
+  uplinkHdr.AddLinkAdrAns (true, false, true);
+  uplinkHdr.AddDutyCycleAns ();
+  uplinkHdr.AddLinkCheckReq ();
+
+  LoraFrameHeader uplinkObjectHdr;
+  uplinkObjectHdr.SetAsUplink ();
+  uplinkObjectHdr.AddCommand (Create<LinkAdrAns> (true, false, true));
+  uplinkObjectHdr.AddCommand (Create<DutyCycleAns> ());
+  uplinkObjectHdr.AddCommand (Create<LinkCheckReq> ());
+  checkSameBytes (uplinkHdr, uplinkObjectHdr);
+
+  NS_TEST_EXPECT_MSG_EQ (uplinkHdr.GetMacCommand<LinkAdrReq> (), 0,
+                         "Found a downlink command in an uplink header");
+  NS_TEST_EXPECT_MSG_NE (uplinkHdr.GetMacCommand<LinkCheckReq> (), 0,
+                         "Command after other commands was not found");
 }
 
 /*******************
@@ -394,11 +666,16 @@ private:
   void NoMoreDemodulators (Ptr<const Packet> packet, uint32_t node);
   void Interference (Ptr<const Packet> packet, uint32_t node);
   void ReceivedPacket (Ptr<const Packet> packet, uint32_t node);
+  void NoReceptionBecauseTransmitting (Ptr<const Packet> packet, uint32_t node);
+  void StartSending (Ptr<const Packet> packet, uint32_t node, double duration);
 
   Ptr<SimpleGatewayLoraPhy> gatewayPhy;
   int m_noMoreDemodulatorsCalls = 0;
   int m_interferenceCalls = 0;
   int m_receivedPacketCalls = 0;
+  int m_noReceptionBecauseTransmittingCalls = 0;
+  int m_startSendingCalls = 0;
+  int m_occupiedReceptionPaths = 0;
   int m_maxOccupiedReceptionPaths = 0;
 };
 
@@ -446,6 +723,7 @@ ReceivePathTest::OccupiedReceptionPaths (int oldValue, int newValue)
 {
   NS_LOG_FUNCTION (oldValue << newValue);
 
+  m_occupiedReceptionPaths = newValue;
   if (m_maxOccupiedReceptionPaths < newValue)
     {
       m_maxOccupiedReceptionPaths = newValue;
@@ -476,6 +754,22 @@ ReceivePathTest::ReceivedPacket (Ptr<const Packet> packet, uint32_t node)
   m_receivedPacketCalls++;
 }
 
+void
+ReceivePathTest::NoReceptionBecauseTransmitting (Ptr<const Packet> packet, uint32_t node)
+{
+  NS_LOG_FUNCTION (packet << node);
+
+  m_noReceptionBecauseTransmittingCalls++;
+}
+
+void
+ReceivePathTest::StartSending (Ptr<const Packet> packet, uint32_t node, double duration)
+{
+  NS_LOG_FUNCTION (packet << node << duration);
+
+  m_startSendingCalls++;
+}
+
 // This method is the pure virtual method from class TestCase that every
 // TestCase must implement
 void
@@ -487,6 +781,89 @@ ReceivePathTest::DoRun (void)
 
   Reset ();
 
+  ///////////////////////////////////////////////////////////////////////////
+  // A gateway with more than 64 reception paths can use all of them, and
+  // frees them when the receptions end
+  ///////////////////////////////////////////////////////////////////////////
+
+  gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  gatewayPhy->TraceConnectWithoutContext (
+      "LostPacketBecauseNoMoreReceivers",
+      MakeCallback (&ReceivePathTest::NoMoreDemodulators, this));
+  gatewayPhy->TraceConnectWithoutContext (
+      "OccupiedReceptionPaths", MakeCallback (&ReceivePathTest::OccupiedReceptionPaths, this));
+  gatewayPhy->TraceConnectWithoutContext ("LostPacketBecauseInterference",
+                                          MakeCallback (&ReceivePathTest::Interference, this));
+  gatewayPhy->TraceConnectWithoutContext ("ReceivedPacket",
+                                          MakeCallback (&ReceivePathTest::ReceivedPacket, this));
+  for (int i = 0; i < 70; i++)
+    {
+      gatewayPhy->AddReceptionPath ();
+    }
+
+  for (int i = 0; i < 71; i++)
+    {
+      Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                           Create<Packet> (), 14, 7 + i % 6, Seconds (1), 868.1);
+      Simulator::Schedule (Seconds (3), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                           Create<Packet> (), 14, 7 + i % 6, Seconds (1), 868.1);
+    }
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_noMoreDemodulatorsCalls, 2, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_maxOccupiedReceptionPaths, 70, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls + m_receivedPacketCalls, 140, "Unexpected value");
+
+  ///////////////////////////////////////////////////////////////////////////
+  // A transmission interrupts all receptions and frees their reception
+  // paths, so that a gateway without Tx priority can transmit again
+  ///////////////////////////////////////////////////////////////////////////
+
+  m_occupiedReceptionPaths = 0;
+  m_maxOccupiedReceptionPaths = 0;
+
+  gatewayPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  gatewayPhy->TraceConnectWithoutContext (
+      "OccupiedReceptionPaths", MakeCallback (&ReceivePathTest::OccupiedReceptionPaths, this));
+  gatewayPhy->TraceConnectWithoutContext (
+      "NoReceptionBecauseTransmitting",
+      MakeCallback (&ReceivePathTest::NoReceptionBecauseTransmitting, this));
+  gatewayPhy->TraceConnectWithoutContext ("StartSending",
+                                          MakeCallback (&ReceivePathTest::StartSending, this));
+  for (int i = 0; i < 8; i++)
+    {
+      gatewayPhy->AddReceptionPath ();
+    }
+  gatewayPhy->SetMobility (CreateObject<ConstantPositionMobilityModel> ());
+  gatewayPhy->SetChannel (CreateObject<LoraChannel> (CreateObject<LogDistancePropagationLossModel> (),
+                                                     CreateObject<ConstantSpeedPropagationDelayModel> ()));
+
+  for (int i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1), &SimpleGatewayLoraPhy::StartReceive, gatewayPhy,
+                           Create<Packet> (), 14, 7 + i, Seconds (2), 868.1);
+    }
+  LoraTxParameters txParams;
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gatewayPhy,
+                       Create<Packet> (10), txParams, 869.525, 27);
+  Simulator::Schedule (Seconds (3), &SimpleGatewayLoraPhy::SetGatewayTransmissionPriority,
+                       gatewayPhy, false);
+  Simulator::Schedule (Seconds (4), &SimpleGatewayLoraPhy::Send, gatewayPhy,
+                       Create<Packet> (10), txParams, 869.525, 27);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_maxOccupiedReceptionPaths, 3, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_noReceptionBecauseTransmittingCalls, 3, "Unexpected value");
+  NS_TEST_EXPECT_MSG_EQ (m_occupiedReceptionPaths, 0,
+                         "Interrupted receptions did not free their reception paths");
+  NS_TEST_EXPECT_MSG_EQ (m_startSendingCalls, 2, "Unexpected value");
+
   // FIXME
   // //////////////////////////////////////////////////////////////////////////////////
   // // If no ReceptionPath is configured to listen on a frequency, no packet is received
@@ -847,6 +1224,97 @@ LogicalLoraChannelTest::DoRun (void)
                          "Waiting time affects other subbands");
   NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (channel5), Time (0),
                          "Waiting time affects other subbands");
+
+  // Enabled channels
+  ///////////////////
+
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetNEnabledChannels (), 5,
+                         "Unexpected number of enabled channels");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetEnabledChannelWaitingTime (0), expectedTimeOff,
+                         "Waiting time doesn't behave as expected");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetEnabledChannelWaitingTime (3), Time (0),
+                         "Waiting time affects other subbands");
+
+  // Disabled channels are skipped
+  channelHelper->DisableChannel (0);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetNEnabledChannels (), 4,
+                         "Unexpected number of enabled channels");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetEnabledChannel (0), channel2,
+                         "Disabled channel was not skipped");
+
+  // Enabled channels are taken into account again
+  channelHelper->EnableChannel (0);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetNEnabledChannels (), 5,
+                         "Unexpected number of enabled channels");
+
+  // Earliest transmission across enabled channels
+  ////////////////////////////////////////////////
+
+  // A channel of the second SubBand is still free
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetMinWaitingTime (), Time (0),
+                         "Minimum waiting time doesn't behave as expected");
+
+  // Once it is busy, the earliest one is the second SubBand
+  channelHelper->AddEvent (Seconds (1), channel4);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetMinWaitingTime (), Seconds (1 / 0.1 - 1),
+                         "Minimum waiting time doesn't behave as expected");
+
+  // Disabled SubBands are not taken into account
+  channelHelper->DisableChannel (3);
+  channelHelper->DisableChannel (4);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetMinWaitingTime (), expectedTimeOff,
+                         "Minimum waiting time doesn't behave as expected");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetNextTransmissionTime (),
+                         subBand.GetNextTransmissionTime (),
+                         "Next transmission time doesn't behave as expected");
+
+  // SubBands are found regardless of the order they are added in
+  SubBand subBand2 (867, 867.6, 0.01, 14);
+  channelHelper->AddSubBand (&subBand2);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetSubBandFromFrequency (867.1), &subBand2,
+                         "Wrong SubBand for frequency");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetSubBandFromFrequency (868.1), &subBand,
+                         "Wrong SubBand for frequency");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetSubBandFromFrequency (869.1), &subBand1,
+                         "Wrong SubBand for frequency");
+
+  // Frequency-based lookups
+  //////////////////////////
+
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (868.3),
+                         channelHelper->GetWaitingTime (channel2),
+                         "Waiting time doesn't behave as expected");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetTxPowerForFrequency (869.1), 27,
+                         "Wrong maximum power for frequency");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetTxPowerForFrequency (868.1),
+                         channelHelper->GetTxPowerForChannel (channel1),
+                         "Wrong maximum power for frequency");
+
+  channelHelper->AddEvent (Seconds (1), 867.1);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetWaitingTime (867.3), Seconds (1 / 0.01 - 1),
+                         "Waiting time doesn't behave as expected");
+
+  // Outdated transmission times do not pile up
+  /////////////////////////////////////////////
+
+  channelHelper->EnableChannel (3);
+  channelHelper->EnableChannel (4);
+  for (int i = 1; i <= 1000; i++)
+    {
+      channelHelper->AddEvent (MilliSeconds (i), (i % 2) ? channel1 : channel4);
+      if (i % 3 == 0)
+        {
+          channelHelper->GetNextTransmissionTime ();
+        }
+    }
+
+  // At most two entries for each of the three SubBands
+  NS_TEST_EXPECT_MSG_LT (channelHelper->GetNTrackedTransmissionTimes (), 7,
+                         "Outdated transmission times were not dropped");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper->GetNextTransmissionTime (),
+                         Min (subBand.GetNextTransmissionTime (),
+                              subBand1.GetNextTransmissionTime ()),
+                         "Next transmission time doesn't behave as expected");
 }
 
 /*****************
@@ -957,6 +1425,35 @@ TimeOnAirTest::DoRun (void)
   txParams.codingRate = 1;
   duration = LoraPhy::GetOnAirTime (packet, txParams);
   NS_TEST_EXPECT_MSG_EQ_TOL (duration.GetSeconds (), 2.301952, 0.0001, "Unexpected duration");
+
+  // Times looked up in the table match the formula exactly
+  const double bandwidths[3] = {125000, 250000, 500000};
+  for (uint32_t size = 0; size <= 255; size++)
+    {
+      packet = Create<Packet> (size);
+      for (uint8_t sf = 7; sf <= 12; sf++)
+        {
+          for (double bandwidth : bandwidths)
+            {
+              for (uint8_t codingRate = 1; codingRate <= 4; codingRate++)
+                {
+                  for (int flags = 0; flags < 8; flags++)
+                    {
+                      LoraTxParameters params;
+                      params.sf = sf;
+                      params.bandwidthHz = bandwidth;
+                      params.codingRate = codingRate;
+                      params.headerDisabled = flags & 1;
+                      params.crcEnabled = flags & 2;
+                      params.lowDataRateOptimizationEnabled = flags & 4;
+                      NS_TEST_ASSERT_MSG_EQ (LoraPhy::GetOnAirTime (packet, params),
+                                             LoraPhy::ComputeOnAirTime (size, params),
+                                             "Stored duration differs from the formula");
+                    }
+                }
+            }
+        }
+    }
 }
 
 /**************************
@@ -975,6 +1472,7 @@ public:
   void NoMoreDemodulators (Ptr<const Packet> packet, uint32_t node);
   void WrongFrequency (Ptr<const Packet> packet, uint32_t node);
   void WrongSf (Ptr<const Packet> packet, uint32_t node);
+  void DroppedInterferenceEvents (uint32_t oldValue, uint32_t newValue);
   bool HaveSamePacketContents (Ptr<Packet> packet1, Ptr<Packet> packet2);
 
 private:
@@ -991,6 +1489,7 @@ private:
   int m_noMoreDemodulatorsCalls = 0;
   int m_wrongSfCalls = 0;
   int m_wrongFrequencyCalls = 0;
+  uint32_t m_droppedInterferenceEvents = 0;
 };
 
 // Add some help text to this case to describe what it is intended to test
@@ -1030,6 +1529,14 @@ PhyConnectivityTest::Interference (Ptr<const Packet> packet, uint32_t node)
   m_interferenceCalls++;
 }
 
+void
+PhyConnectivityTest::DroppedInterferenceEvents (uint32_t oldValue, uint32_t newValue)
+{
+  NS_LOG_FUNCTION (oldValue << newValue);
+
+  m_droppedInterferenceEvents = newValue;
+}
+
 void
 PhyConnectivityTest::NoMoreDemodulators (Ptr<const Packet> packet, uint32_t node)
 {
@@ -1089,6 +1596,7 @@ PhyConnectivityTest::Reset (void)
   m_interferenceCalls = 0;
   m_wrongSfCalls = 0;
   m_wrongFrequencyCalls = 0;
+  m_droppedInterferenceEvents = 0;
 
   Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
   loss->SetPathLossExponent (3.76);
@@ -1280,6 +1788,118 @@ PhyConnectivityTest::DoRun (void)
 
   Reset ();
 
+  // Receivers that are out of reach are culled by the channel
+
+  txParams.sf = 7;
+  edPhy2->SetSpreadingFactor (7);
+  edPhy2->GetMobility ()->GetObject<ConstantPositionMobilityModel> ()->SetPosition (
+      Vector (50000, 0, 0));
+  channel->SetAttribute ("ReceiverCulling", BooleanValue (true));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_underSensitivityCalls, 0,
+                         "Culled receiver was notified of the transmission");
+  NS_TEST_EXPECT_MSG_EQ (m_wrongSfCalls, 1,
+                         "Receiver within the culling cutoff was not notified");
+
+  Reset ();
+
+  // Receivers beyond the maximum range are not notified, and moving a PHY
+  // updates the spatial index of the channel
+
+  txParams.sf = 12;
+  channel->SetAttribute ("MaxRange", DoubleValue (1000));
+  edPhy2->GetMobility ()->GetObject<ConstantPositionMobilityModel> ()->SetPosition (
+      Vector (2990, 0, 0));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1,
+                         "Packet was not delivered to the right set of PHYs");
+
+  edPhy2->GetMobility ()->GetObject<ConstantPositionMobilityModel> ()->SetPosition (
+      Vector (990, 0, 0));
+
+  Simulator::Schedule (Seconds (10), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams,
+                       868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 3,
+                         "Moved PHY was not notified of the transmission");
+
+  Reset ();
+
+  // Stored link budgets match the loss model, and are updated when a PHY
+  // moves
+
+  channel->SetAttribute ("StaticTopology", BooleanValue (true));
+  Ptr<LoraPhy> phy1 = edPhy1;
+  Ptr<LoraPhy> phy2 = edPhy2;
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetRxPower (14, phy1, phy2),
+                             channel->GetRxPower (14, edPhy1->GetMobility (),
+                                                  edPhy2->GetMobility ()),
+                             0.001, "Stored link budget differs from the loss model");
+  NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetRxPower (14, phy2, phy1),
+                             channel->GetRxPower (14, edPhy2->GetMobility (),
+                                                  edPhy1->GetMobility ()),
+                             0.001, "Stored link budget differs from the loss model");
+
+  edPhy2->GetMobility ()->GetObject<ConstantPositionMobilityModel> ()->SetPosition (
+      Vector (990, 0, 0));
+
+  NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetRxPower (14, phy1, phy2),
+                             channel->GetRxPower (14, edPhy1->GetMobility (),
+                                                  edPhy2->GetMobility ()),
+                             0.001, "Link budget was not updated after a course change");
+  NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetRxPower (14, phy2, phy1),
+                             channel->GetRxPower (14, edPhy2->GetMobility (),
+                                                  edPhy1->GetMobility ()),
+                             0.001, "Link budget was not updated after a course change");
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2,
+                         "Channel skipped some PHYs when using stored link budgets");
+
+  Reset ();
+
+  // Batched delivery notifies the same PHYs
+
+  channel->SetAttribute ("BatchedDelivery", BooleanValue (true));
+  channel->SetAttribute ("DelayResolution", TimeValue (MicroSeconds (100)));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2,
+                         "Channel skipped some PHYs when batching deliveries");
+
+  Reset ();
+
   // Packets can be destroyed by interference
 
   txParams.sf = 12;
@@ -1297,6 +1917,227 @@ PhyConnectivityTest::DoRun (void)
 
   Reset ();
 
+  // The same happens when interference is evaluated on the channel's shared
+  // record of transmissions
+
+  channel->SetAttribute ("SharedInterference", BooleanValue (true));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy3, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1,
+                         "Packets that should be destroyed by interference weren't");
+
+  // An interference floor below the power of the signals does not change the
+  // outcome, while one above it makes the receiver ignore the interferer,
+  // whether or not interference is shared
+
+  for (bool sharedInterference : {false, true})
+    {
+      Reset ();
+
+      channel->SetAttribute ("SharedInterference", BooleanValue (sharedInterference));
+      edPhy2->SetAttribute ("InterferenceFloor", DoubleValue (-100));
+      edPhy2->TraceConnectWithoutContext (
+          "DroppedInterferenceEvents",
+          MakeCallback (&PhyConnectivityTest::DroppedInterferenceEvents, this));
+
+      Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams,
+                           868.1, 14);
+      Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy3, packet, txParams,
+                           868.1, 14);
+
+      Simulator::Stop (Hours (2));
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1,
+                             "Interference floor changed the outcome of a reception");
+      NS_TEST_EXPECT_MSG_EQ (m_droppedInterferenceEvents, 0,
+                             "Signals above the interference floor were dropped");
+
+      Reset ();
+
+      channel->SetAttribute ("SharedInterference", BooleanValue (sharedInterference));
+      edPhy2->SetAttribute ("InterferenceFloor", DoubleValue (0));
+      edPhy2->TraceConnectWithoutContext (
+          "DroppedInterferenceEvents",
+          MakeCallback (&PhyConnectivityTest::DroppedInterferenceEvents, this));
+
+      Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams,
+                           868.1, 14);
+      Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy3, packet, txParams,
+                           868.1, 14);
+
+      Simulator::Stop (Hours (2));
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 0,
+                             "Interferer below the floor destroyed the packet");
+      NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1,
+                             "Packet was not received with the interferer below the floor");
+      // Without sharing, both incoming signals are dropped when they arrive.
+      // Otherwise, only the interferer is dropped when the reception ends.
+      NS_TEST_EXPECT_MSG_EQ (m_droppedInterferenceEvents, (sharedInterference ? 1u : 2u),
+                             "Signals below the interference floor were not counted");
+    }
+
+  Reset ();
+
+  // With lazy reception, sleeping PHYs are not notified of transmissions, but
+  // a transmission that started while a PHY was asleep still interferes with
+  // the packets it receives after waking up
+
+  channel->SetAttribute ("LazyReception", BooleanValue (true));
+
+  edPhy1->SwitchToSleep ();
+  edPhy2->SwitchToSleep ();
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy3, packet, txParams, 868.1,
+                       14);
+  Simulator::Schedule (Seconds (2.1), &EndDeviceLoraPhy::SwitchToStandby, edPhy2);
+  Simulator::Schedule (Seconds (2.1), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams,
+                       868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1,
+                         "Interference from a transmission started during sleep was missed");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 0, "Packet was received by a PHY in SLEEP mode");
+
+  Reset ();
+
+  // With role-aware delivery, end devices do not try to receive uplinks from
+  // other end devices, but still register them as interference
+
+  channel->SetAttribute ("RoleAwareDelivery", BooleanValue (true));
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::StartReceive, edPhy2, packet, -130,
+                       12, Seconds (1), 868.1);
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 0, "End device received an uplink");
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1,
+                         "Uplink delivered as interference did not destroy the packet");
+
+  Reset ();
+
+  // With address filtering, end devices only lock on downlinks for their own
+  // address or broadcast, but still register the other ones as interference.
+  // Gateways set the destination in the LoraTag of each downlink.
+
+  Ptr<SimpleGatewayLoraPhy> gwPhy = CreateObject<SimpleGatewayLoraPhy> ();
+  Ptr<ConstantPositionMobilityModel> gwMob = CreateObject<ConstantPositionMobilityModel> ();
+  gwMob->SetPosition (Vector (5.0, 0.0, 0.0));
+  gwPhy->SetMobility (gwMob);
+
+  LoraDeviceAddress address2 (1, 2);
+  LoraDeviceAddress address3 (1, 3);
+
+  auto makeDownlink = [] (LoraDeviceAddress address)
+    {
+      Ptr<Packet> downlink = Create<Packet> (10);
+      LoraFrameHeader frameHdr;
+      frameHdr.SetAsDownlink ();
+      frameHdr.SetAddress (address);
+      downlink->AddHeader (frameHdr);
+      LorawanMacHeader macHdr;
+      macHdr.SetMType (LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+      downlink->AddHeader (macHdr);
+      LoraTag tag;
+      tag.SetDestination (address);
+      downlink->AddPacketTag (tag);
+      return downlink;
+    };
+
+  // A beacon, as sent by GatewayLorawanMac::SendBeacon
+  Ptr<Packet> beacon = Create<Packet> (10);
+  LorawanMacHeader beaconMacHdr;
+  beaconMacHdr.SetMType (LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+  beacon->AddHeader (beaconMacHdr);
+  LoraTag beaconTag;
+  beaconTag.SetDestination (LoraDeviceAddress::GetBroadcast ());
+  beacon->AddPacketTag (beaconTag);
+
+  auto enableFiltering = [&] ()
+    {
+      channel->SetAttribute ("AddressFiltering", BooleanValue (true));
+      gwPhy->SetChannel (channel);
+      edPhy1->SwitchToSleep ();
+      edPhy2->SetAddressFilter (address2);
+      edPhy3->SetAddressFilter (address3);
+    };
+
+  enableFiltering ();
+
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gwPhy, makeDownlink (address3),
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1,
+                         "Downlink was not received by its destination only");
+
+  Reset ();
+  enableFiltering ();
+
+  Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::StartReceive, edPhy2, packet, -130,
+                       12, Seconds (1), 868.1);
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gwPhy, makeDownlink (address3),
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1,
+                         "Downlink was not received by its destination only");
+  NS_TEST_EXPECT_MSG_EQ (m_interferenceCalls, 1,
+                         "Filtered downlink did not interfere with another reception");
+
+  Reset ();
+  enableFiltering ();
+
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gwPhy, makeDownlink (address2),
+                       txParams, 868.1, 14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 1,
+                         "Filtering PHY did not lock on its own downlink");
+
+  Reset ();
+  enableFiltering ();
+
+  Simulator::Schedule (Seconds (2), &SimpleGatewayLoraPhy::Send, gwPhy, beacon, txParams, 868.1,
+                       14);
+
+  Simulator::Stop (Hours (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacketCalls, 2, "Filtering PHYs did not lock on a beacon");
+
+  Reset ();
+
   // Packets can be lost because the PHY is not listening on the right frequency
 
   Simulator::Schedule (Seconds (2), &SimpleEndDeviceLoraPhy::Send, edPhy1, packet, txParams, 868.3,
@@ -1391,6 +2232,314 @@ void
 LorawanMacTest::DoRun (void)
 {
   NS_LOG_DEBUG ("LorawanMacTest");
+
+  // Region profiles
+  //////////////////
+
+  LorawanMacHelper macHelper;
+  macHelper.SetDeviceType (LorawanMacHelper::ED_A);
+  macHelper.SetRegion (LorawanMacHelper::EU);
+  Ptr<LorawanMac> edMac1 = macHelper.Create (0, 0);
+  Ptr<LorawanMac> edMac2 = macHelper.Create (0, 0);
+
+  // Regional parameters are shared
+  NS_TEST_EXPECT_MSG_EQ (edMac1->GetRegionProfile (), macHelper.GetRegionProfile (),
+                         "Region profile is not shared");
+  NS_TEST_EXPECT_MSG_EQ (edMac2->GetRegionProfile (), macHelper.GetRegionProfile (),
+                         "Region profile is not shared");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (edMac1->GetSfFromDataRate (0)), 12,
+                         "Wrong SF for DR0");
+  NS_TEST_EXPECT_MSG_EQ (edMac1->GetDbmForTxPower (1), 14,
+                         "Wrong power for TxPower 1");
+
+  // So are the default channels
+  LogicalLoraChannelHelper channelHelper1 = edMac1->GetLogicalLoraChannelHelper ();
+  LogicalLoraChannelHelper channelHelper2 = edMac2->GetLogicalLoraChannelHelper ();
+  NS_TEST_EXPECT_MSG_EQ (PeekPointer (channelHelper1.GetChannelList ().at (0)),
+                         PeekPointer (channelHelper2.GetChannelList ().at (0)),
+                         "Default channel is not shared");
+
+  // Changing a parameter only affects one MAC
+  edMac1->SetSfForDataRate (std::vector<uint8_t>{7});
+  NS_TEST_EXPECT_MSG_EQ (unsigned (edMac1->GetSfFromDataRate (0)), 7,
+                         "SF for DR0 was not changed");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (edMac2->GetSfFromDataRate (0)), 12,
+                         "SF for DR0 was changed on another MAC");
+  NS_TEST_EXPECT_MSG_EQ (edMac2->GetRegionProfile (), macHelper.GetRegionProfile (),
+                         "Region profile was modified");
+
+  // Disabling a channel only affects one helper
+  channelHelper1.DisableChannel (0);
+  NS_TEST_EXPECT_MSG_EQ (channelHelper1.GetNEnabledChannels (), 2,
+                         "Channel was not disabled");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper2.GetNEnabledChannels (), 3,
+                         "Channel was disabled on another helper");
+  NS_TEST_EXPECT_MSG_EQ (channelHelper2.GetChannelList ().at (0)->IsEnabledForUplink (), true,
+                         "Shared channel was modified");
+}
+
+/*******************
+ * BeaconTimerTest *
+ *******************/
+
+class BeaconTimerTest : public TestCase
+{
+public:
+  BeaconTimerTest ();
+  virtual ~BeaconTimerTest ();
+
+  void EndDeviceState (std::string context, EndDeviceLoraPhy::State oldState,
+                       EndDeviceLoraPhy::State newState);
+  void SentBeacon (std::string context, Ptr<Packet const> packet);
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<std::vector<Time> > m_windowTimes; //!< Beacon windows opened by each ED
+  std::vector<std::vector<Time> > m_beaconTimes; //!< Beacons sent by each gateway
+};
+
+// Add some help text to this case to describe what it is intended to test
+BeaconTimerTest::BeaconTimerTest ()
+    : TestCase ("Verify that the BeaconTimer notifies the registered devices")
+{
+}
+
+// Reminder that the test case should clean up after itself
+BeaconTimerTest::~BeaconTimerTest ()
+{
+}
+
+void
+BeaconTimerTest::EndDeviceState (std::string context, EndDeviceLoraPhy::State oldState,
+                                 EndDeviceLoraPhy::State newState)
+{
+  if (newState == EndDeviceLoraPhy::STANDBY)
+    {
+      m_windowTimes.at (std::stoul (context)).push_back (Simulator::Now ());
+    }
+}
+
+void
+BeaconTimerTest::SentBeacon (std::string context, Ptr<Packet const> packet)
+{
+  m_beaconTimes.at (std::stoul (context)).push_back (Simulator::Now ());
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+BeaconTimerTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("BeaconTimerTest");
+
+  Ptr<BeaconTimer> beaconTimer = CreateObject<BeaconTimer> ();
+
+  // Beacon times
+  ///////////////
+
+  // The first beacon is sent at the end of the first beacon period
+  NS_TEST_EXPECT_MSG_EQ (beaconTimer->GetNextBeaconTime (),
+                         Seconds (128) + MicroSeconds (1500),
+                         "Wrong time for the first beacon");
+
+  // Beacon times do not drift, even after years of beacon periods
+  uint64_t index = 1000000;
+  NS_TEST_EXPECT_MSG_EQ (beaconTimer->GetBeaconTime (index) - beaconTimer->GetBeaconTime (index - 1),
+                         Seconds (128), "Beacon period drifted");
+  NS_TEST_EXPECT_MSG_EQ (beaconTimer->GetBeaconTime (index) - MicroSeconds (1500),
+                         Seconds (128) * static_cast<int64_t> (index),
+                         "Beacon time drifted");
+
+  // Registration and dispatch
+  ////////////////////////////
+
+  Ptr<LoraChannel> channel =
+      CreateObject<LoraChannel> (CreateObject<LogDistancePropagationLossModel> (),
+                                 CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  LorawanMacHelper macHelper;
+  macHelper.SetRegion (LorawanMacHelper::EU);
+
+  uint32_t nDevices = 2;
+  m_windowTimes.assign (nDevices, std::vector<Time> ());
+  m_beaconTimes.assign (nDevices, std::vector<Time> ());
+  std::vector<Ptr<ClassBEndDeviceLorawanMac> > edMacs;
+  std::vector<Ptr<GatewayLorawanMac> > gwMacs;
+  for (uint32_t i = 0; i < nDevices; i++)
+    {
+      std::string context = std::to_string (i);
+
+      macHelper.SetDeviceType (LorawanMacHelper::ED_B);
+      Ptr<ClassBEndDeviceLorawanMac> edMac =
+          macHelper.Create (0, 0)->GetObject<ClassBEndDeviceLorawanMac> ();
+      Ptr<SimpleEndDeviceLoraPhy> edPhy = CreateObject<SimpleEndDeviceLoraPhy> ();
+      edMac->SetPhy (edPhy);
+      edPhy->TraceConnect ("EndDeviceState", context,
+                           MakeCallback (&BeaconTimerTest::EndDeviceState, this));
+      edMacs.push_back (edMac);
+
+      // Gateways transmit on the channel, but nobody listens to them
+      macHelper.SetDeviceType (LorawanMacHelper::GW);
+      Ptr<GatewayLorawanMac> gwMac =
+          macHelper.Create (0, 0)->GetObject<GatewayLorawanMac> ();
+      Ptr<SimpleGatewayLoraPhy> gwPhy = CreateObject<SimpleGatewayLoraPhy> ();
+      Ptr<ConstantPositionMobilityModel> gwMobility =
+          CreateObject<ConstantPositionMobilityModel> ();
+      gwMobility->SetPosition (Vector (1000.0 * i, 0.0, 0.0));
+      gwPhy->SetMobility (gwMobility);
+      gwPhy->SetChannel (channel);
+      gwMac->SetPhy (gwPhy);
+      gwMac->TraceConnect ("SentNewPacket", context,
+                           MakeCallback (&BeaconTimerTest::SentBeacon, this));
+      gwMacs.push_back (gwMac);
+
+      beaconTimer->AddEndDevice (edMac);
+      beaconTimer->AddGateway (gwMac);
+    }
+
+  // The second devices leave after the first beacon, and everybody leaves
+  // after the second one
+  Simulator::Schedule (Seconds (200), &BeaconTimer::RemoveEndDevice, beaconTimer,
+                       edMacs.at (1));
+  Simulator::Schedule (Seconds (200), &BeaconTimer::RemoveGateway, beaconTimer,
+                       gwMacs.at (1));
+  Simulator::Schedule (Seconds (300), &BeaconTimer::RemoveEndDevice, beaconTimer,
+                       edMacs.at (0));
+  Simulator::Schedule (Seconds (300), &BeaconTimer::RemoveGateway, beaconTimer,
+                       gwMacs.at (0));
+
+  // Once the timer is idle, no more beacons are sent
+  Simulator::Stop (Seconds (1000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<Time> expectedTimes = {beaconTimer->GetBeaconTime (1),
+                                     beaconTimer->GetBeaconTime (2)};
+  for (uint32_t i = 0; i < nDevices; i++)
+    {
+      std::size_t nBeacons = (i == 0) ? 2 : 1;
+
+      NS_TEST_ASSERT_MSG_EQ (m_windowTimes.at (i).size (), nBeacons,
+                             "Wrong number of beacon windows opened by ED " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_beaconTimes.at (i).size (), nBeacons,
+                             "Wrong number of beacons sent by gateway " << i);
+      for (std::size_t j = 0; j < nBeacons; j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_windowTimes.at (i).at (j), expectedTimes.at (j),
+                                 "ED " << i << " opened a beacon window at the wrong time");
+          NS_TEST_EXPECT_MSG_EQ (m_beaconTimes.at (i).at (j), expectedTimes.at (j),
+                                 "Gateway " << i << " sent a beacon at the wrong time");
+        }
+    }
+}
+
+/**********************
+ * ClassBPingSlotTest *
+ *********************/
+
+class ClassBPingSlotTest : public TestCase
+{
+public:
+  ClassBPingSlotTest ();
+  virtual ~ClassBPingSlotTest ();
+
+  void EndDeviceState (EndDeviceLoraPhy::State oldState,
+                       EndDeviceLoraPhy::State newState);
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<Time> m_standbyTimes;
+};
+
+// Add some help text to this case to describe what it is intended to test
+ClassBPingSlotTest::ClassBPingSlotTest ()
+    : TestCase ("Verify that class B EDs open ping slots after a beacon")
+{
+}
+
+// Reminder that the test case should clean up after itself
+ClassBPingSlotTest::~ClassBPingSlotTest ()
+{
+}
+
+void
+ClassBPingSlotTest::EndDeviceState (EndDeviceLoraPhy::State oldState,
+                                    EndDeviceLoraPhy::State newState)
+{
+  if (newState == EndDeviceLoraPhy::STANDBY)
+    {
+      m_standbyTimes.push_back (Simulator::Now ());
+    }
+}
+
+// This method is the pure virtual method from class TestCase that every
+// TestCase must implement
+void
+ClassBPingSlotTest::DoRun (void)
+{
+  NS_LOG_DEBUG ("ClassBPingSlotTest");
+
+  LorawanMacHelper macHelper;
+  macHelper.SetDeviceType (LorawanMacHelper::ED_B);
+  macHelper.SetRegion (LorawanMacHelper::EU);
+
+  Time beaconTime = Seconds (10);
+
+  for (uint8_t periodicity : {0, 4, 7})
+    {
+      m_standbyTimes.clear ();
+
+      Ptr<ClassBEndDeviceLorawanMac> edMac =
+          macHelper.Create (0, 0)->GetObject<ClassBEndDeviceLorawanMac> ();
+      Ptr<SimpleEndDeviceLoraPhy> edPhy = CreateObject<SimpleEndDeviceLoraPhy> ();
+      edMac->SetPhy (edPhy);
+      // Address 0 is the broadcast address
+      edMac->SetDeviceAddress (LoraDeviceAddress (1, 1));
+      edMac->SetPingSlotPeriodicity (periodicity);
+      // The PHY is listening when the beacon arrives
+      edPhy->SwitchToStandby ();
+      edPhy->TraceConnectWithoutContext
+        ("EndDeviceState", MakeCallback (&ClassBPingSlotTest::EndDeviceState, this));
+
+      // A beacon, as sent by GatewayLorawanMac::SendBeacon
+      Ptr<Packet> beacon = Create<Packet> (10);
+      LoraBeaconTag beaconTag;
+      beaconTag.SetTime (beaconTime.GetSeconds ());
+      beacon->AddPacketTag (beaconTag);
+      LorawanMacHeader macHdr;
+      macHdr.SetMType (LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+      macHdr.SetMajor (1);
+      beacon->AddHeader (macHdr);
+
+      Simulator::Schedule (beaconTime, &ClassBEndDeviceLorawanMac::Receive,
+                           edMac, beacon);
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      // Slots open at the same times as when they were all scheduled on
+      // beacon reception
+      double spacing = 0.96 * std::pow (2, periodicity);
+      std::vector<Time> expectedTimes;
+      for (int i = 1; i < 128; i++)
+        {
+          if (i * spacing > 128)
+            {
+              break;
+            }
+          expectedTimes.push_back (beaconTime + Seconds (i * spacing));
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (m_standbyTimes.size (), expectedTimes.size (),
+                             "Wrong number of ping slots for periodicity "
+                             << unsigned (periodicity));
+      for (std::size_t i = 0; i < expectedTimes.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_standbyTimes.at (i), expectedTimes.at (i),
+                                 "Ping slot " << i + 1 << " opened at the wrong time");
+        }
+    }
 }
 
 /**************
@@ -1412,12 +2561,16 @@ LorawanTestSuite::LorawanTestSuite () : TestSuite ("lorawan", UNIT)
   LogComponentEnable ("LorawanTestSuite", LOG_LEVEL_DEBUG);
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new InterferenceTest, TestCase::QUICK);
+  AddTestCase (new InterferenceKernelTest, TestCase::QUICK);
   AddTestCase (new AddressTest, TestCase::QUICK);
   AddTestCase (new HeaderTest, TestCase::QUICK);
   AddTestCase (new ReceivePathTest, TestCase::QUICK);
   AddTestCase (new LogicalLoraChannelTest, TestCase::QUICK);
   AddTestCase (new TimeOnAirTest, TestCase::QUICK);
   AddTestCase (new PhyConnectivityTest, TestCase::QUICK);
+  AddTestCase (new LorawanMacTest, TestCase::QUICK);
+  AddTestCase (new BeaconTimerTest, TestCase::QUICK);
+  AddTestCase (new ClassBPingSlotTest, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -12,6 +12,8 @@
 #include "ns3/log.h"
 #include "ns3/end-device-status.h"
 #include "ns3/network-status.h"
+#include "ns3/uplink-context.h"
+#include "ns3/mac48-address.h"
 #include "utilities.h"
 
 // An essential include is test.h
@@ -102,6 +104,91 @@ NetworkStatusTest::DoRun (void)
   NodeContainer gateways = components.gateways;
 
   ns.AddNode (GetMacLayerFromNode<ClassAEndDeviceLorawanMac> (endDevices.Get (0)));
+
+  // Uplinks are read once, and the same packet forwarded by two gateways is
+  // only stored once
+  Ptr<NetworkStatus> networkStatus = CreateObject<NetworkStatus> ();
+  Ptr<ClassAEndDeviceLorawanMac> edMac =
+    GetMacLayerFromNode<ClassAEndDeviceLorawanMac> (endDevices.Get (0));
+  networkStatus->AddNode (edMac);
+
+  Ptr<Packet> packet = Create<Packet> (10);
+  LoraFrameHeader frameHdr;
+  frameHdr.SetAsUplink ();
+  frameHdr.SetAddress (edMac->GetDeviceAddress ());
+  frameHdr.SetFCnt (5);
+  packet->AddHeader (frameHdr);
+  LorawanMacHeader macHdr;
+  macHdr.SetMType (LorawanMacHeader::CONFIRMED_DATA_UP);
+  packet->AddHeader (macHdr);
+  LoraTag tag;
+  tag.SetFrequency (868.1);
+  packet->AddPacketTag (tag);
+
+  Address firstGateway = Mac48Address ("00:00:00:00:00:01");
+  Address secondGateway = Mac48Address ("00:00:00:00:00:02");
+  Ptr<EndDeviceStatus> edStatus = networkStatus->GetEndDeviceStatus (edMac->GetDeviceAddress ());
+  uint32_t statusReferences = edStatus->GetReferenceCount ();
+  Ptr<const UplinkContext> context =
+    Create<UplinkContext> (packet, firstGateway, networkStatus);
+  NS_TEST_EXPECT_MSG_EQ ((context->GetDeviceAddress () == edMac->GetDeviceAddress ()), true,
+                         "Wrong device address");
+  NS_TEST_EXPECT_MSG_EQ (context->GetFrameHeader ().GetFCnt (), 5, "Wrong FCnt");
+  NS_TEST_EXPECT_MSG_EQ (unsigned (context->GetMacHeader ().GetMType ()),
+                         unsigned (LorawanMacHeader::CONFIRMED_DATA_UP), "Wrong MType");
+  NS_TEST_EXPECT_MSG_EQ (context->GetTag ().GetFrequency (), 868.1, "Wrong frequency");
+  NS_TEST_EXPECT_MSG_EQ (context->GetEndDeviceStatus (), edStatus, "Wrong EndDeviceStatus");
+
+  networkStatus->OnReceivedPacket (context);
+  networkStatus->OnReceivedPacket (Create<UplinkContext> (packet, secondGateway,
+                                                          networkStatus));
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetReceivedPacketList ().size (), 1,
+                         "Packet stored once per gateway");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastReceivedPacketInfo ().gwList.size (), 2,
+                         "Gateway missing from the reception information");
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetLastFrameHeader ().GetFCnt (), 5,
+                         "Frame header of the first reception not kept");
+
+  // Stored uplinks do not keep the status alive once the contexts are gone
+  context = 0;
+  NS_TEST_EXPECT_MSG_EQ (edStatus->GetReferenceCount (), statusReferences,
+                         "Stored uplinks hold a reference to the EndDeviceStatus");
+
+  // Statuses can be kept as handles: adding a device or a gateway again does
+  // not replace them
+  networkStatus->AddNode (edMac);
+  NS_TEST_EXPECT_MSG_EQ (networkStatus->CountEndDevices (), 1, "Device added twice");
+  NS_TEST_EXPECT_MSG_EQ (networkStatus->GetEndDeviceStatus (edMac->GetDeviceAddress ()),
+                         edStatus, "EndDeviceStatus was replaced");
+
+  Ptr<GatewayStatus> firstGwStatus =
+    Create<GatewayStatus> (firstGateway, Ptr<NetDevice> (), Ptr<GatewayLorawanMac> ());
+  Ptr<GatewayStatus> secondGwStatus =
+    Create<GatewayStatus> (secondGateway, Ptr<NetDevice> (), Ptr<GatewayLorawanMac> ());
+  networkStatus->AddGateway (firstGateway, firstGwStatus);
+  networkStatus->AddGateway (secondGateway, secondGwStatus);
+  networkStatus->AddGateway (firstGateway, secondGwStatus);
+  NS_TEST_EXPECT_MSG_EQ (networkStatus->CountGateways (), 2, "Gateway added twice");
+  NS_TEST_EXPECT_MSG_EQ (networkStatus->GetGatewayStatus (firstGateway), firstGwStatus,
+                         "Wrong GatewayStatus");
+  NS_TEST_EXPECT_MSG_EQ (networkStatus->GetGatewayStatus (secondGateway), secondGwStatus,
+                         "Wrong GatewayStatus");
+
+  // Gateway statuses are resolved once, when the uplink is received
+  frameHdr.SetFCnt (6);
+  packet = Create<Packet> (10);
+  packet->AddHeader (frameHdr);
+  packet->AddHeader (macHdr);
+  packet->AddPacketTag (tag);
+  Ptr<const UplinkContext> secondContext =
+    Create<UplinkContext> (packet, secondGateway, networkStatus);
+  NS_TEST_EXPECT_MSG_EQ (secondContext->GetGatewayStatus (), secondGwStatus,
+                         "Wrong GatewayStatus in the context");
+  networkStatus->OnReceivedPacket (secondContext);
+  const EndDeviceStatus::GatewayList &gwList = edStatus->GetLastGatewayList ();
+  NS_TEST_ASSERT_MSG_EQ (gwList.size (), 1, "Wrong number of gateways for the last packet");
+  NS_TEST_EXPECT_MSG_EQ (gwList.begin ()->second.gwStatus, secondGwStatus,
+                         "GatewayStatus not stored with the reception");
 }
 
 /**************